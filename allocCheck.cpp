@@ -0,0 +1,86 @@
+/** \file allocCheck.cpp
+ * Test hook for making sure the main loop stays off the heap.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include "allocCheck.h"
+
+#ifdef CHECK_ALLOCATIONS
+
+#include <cstdlib>
+#include <new>
+
+/*! Allocations made by this thread. Per thread, so the server and capture
+ *  threads don't count against the main loop. */
+static thread_local unsigned long t_allocations = 0;
+
+unsigned long threadAllocations(){
+  return t_allocations;
+}
+
+void* operator new(std::size_t size){
+  t_allocations++;
+  void* p = std::malloc(size ? size : 1);
+  if(!p) throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[](std::size_t size){
+  return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  t_allocations++;
+  return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return operator new(size, std::nothrow);
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+#else
+
+unsigned long threadAllocations(){
+  return 0;
+}
+
+#endif
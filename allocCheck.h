@@ -0,0 +1,41 @@
+/** \file allocCheck.h
+ * Test hook for making sure the main loop stays off the heap.
+ *
+ * When built with -DCHECK_ALLOCATIONS (see CHECKFLAGS in the Makefile),
+ * the global operator new is replaced with one that counts allocations
+ * per thread. main() uses this to check that, after a warm-up period,
+ * processing a frame never allocates. Heap allocation on the Pi shows up
+ * as latency spikes.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#pragma once
+
+/*! Number of heap allocations the calling thread has made so far.
+ *
+ * \return the count, or always 0 if not built with -DCHECK_ALLOCATIONS
+ */
+unsigned long threadAllocations();
@@ -0,0 +1,201 @@
+/** \file bandLocalizer.cpp
+ * Delays between microphones measured separately in a few frequency
+ * bands, spread over several cores.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include "bandLocalizer.h"
+
+#include <cmath>
+#include <string>
+#include <algorithm>
+
+#include "constants.h"
+#include "soundProcessing.h"
+
+/*! Cross spectrum magnitudes smaller than this are treated as zero when
+ *  applying PHAT weighting, as in GccPhat */
+constexpr float BAND_PHAT_EPSILON = 1e-6f;
+
+BandLocalizer::Scratch::Scratch(unsigned int n, int range) :
+  fft(n), cross(n/2 + 1, 0.0f), corr(n, 0.0f), curve(2*range + 1, 0.0f) {
+}
+
+BandLocalizer::BandLocalizer(unsigned int iframes, unsigned int ichannels,
+			     int irange, unsigned int bands,
+			     unsigned int threads) :
+  frames(iframes), channels(ichannels), range(irange), numBands(bands),
+  subsample(false),
+  //Pad so that lags up to range don't wrap around onto each other
+  fft(RealFFT::nextPow2(iframes + irange + 1)),
+  timeScratch(fft.size(), 0.0f),
+  spectra(ichannels, std::vector<std::complex<float> >(fft.size()/2 + 1)),
+  results(bands, std::vector<float>(numPairs(ichannels), 0.0f)),
+  strengths(bands, 0.0f),
+  levels(bands, 0.0f),
+  nextBand(bands),
+  generation(0),
+  pending(0),
+  stopping(false) {
+  if(bands < 1 || bands > MAX_BANDS){
+    throw std::string("can only split the spectrum into 1 to ")
+      + std::to_string(MAX_BANDS) + " bands";
+  }
+
+  //Bin k is k*SAMPLES_PER_SECOND/n Hz. Every band gets at least one bin.
+  unsigned int bins = fft.size()/2 + 1;
+  edges.resize(bands + 1);
+  for(unsigned int b=0; b <= bands; b++){
+    float hz = b == bands ? SAMPLES_PER_SECOND/2.0f : lowEdge(b);
+    edges[b] = std::min(bins, (unsigned int)std::lround(hz*fft.size()
+							/SAMPLES_PER_SECOND));
+    if(b > 0){
+      edges[b] = std::max(edges[b], edges[b-1] + 1);
+    }
+  }
+  edges[bands] = std::min(edges[bands], bins);
+
+  threads = std::max(1u, std::min(threads, bands));
+  for(unsigned int t=0; t < threads; t++){
+    scratch.emplace_back(fft.size(), range);
+  }
+  for(unsigned int t=1; t < threads; t++){
+    workers.emplace_back(&BandLocalizer::workerLoop, this, t);
+  }
+}
+
+BandLocalizer::~BandLocalizer(){
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    stopping = true;
+  }
+  wake.notify_all();
+  for(std::thread& w : workers){
+    w.join();
+  }
+}
+
+float BandLocalizer::lowEdge(unsigned int band) const {
+  float ratio = (SAMPLES_PER_SECOND/2.0f)/BAND_LOW_HZ;
+  return BAND_LOW_HZ*std::pow(ratio, band/(float)numBands);
+}
+
+void BandLocalizer::process(const SoundFrame& frame, bool isubsample){
+  //One transform per channel, shared by every band
+  for(unsigned int ch=0; ch < channels; ch++){
+    const float* in = frame.floats(ch);
+    std::copy(in, in + frames, timeScratch.begin());
+    //The rest is zero padding, which never gets overwritten
+    fft.forward(timeScratch.data(), spectra[ch].data());
+  }
+
+  //Parseval: the mean square of a band is twice its bins' power (their
+  // mirror images count too), over the transform and clip lengths
+  for(unsigned int b=0; b < numBands; b++){
+    float power = 0.0f;
+    for(unsigned int ch=0; ch < channels; ch++){
+      for(unsigned int k=edges[b]; k < edges[b+1]; k++){
+	power += std::norm(spectra[ch][k]);
+      }
+    }
+    levels[b] = std::sqrt(2*power/((float)fft.size()*frames*channels));
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    subsample = isubsample;
+    pending = numBands;
+    generation++;
+    //Last, so a worker that takes a band sees everything above
+    nextBand = 0;
+  }
+  wake.notify_all();
+
+  runBands(scratch[0]);
+  std::unique_lock<std::mutex> guard(lock);
+  finished.wait(guard, [this]{ return pending == 0; });
+}
+
+void BandLocalizer::runBands(Scratch& s){
+  unsigned int band;
+  while((band = nextBand.fetch_add(1)) < numBands){
+    processBand(band, s);
+    std::lock_guard<std::mutex> guard(lock);
+    if(--pending == 0){
+      finished.notify_all();
+    }
+  }
+}
+
+void BandLocalizer::workerLoop(unsigned int id){
+  unsigned long seen = 0;
+  while(true){
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      wake.wait(guard, [this, seen]{ return stopping || generation != seen; });
+      if(stopping){
+	return;
+      }
+      seen = generation;
+    }
+    runBands(scratch[id]);
+  }
+}
+
+void BandLocalizer::processBand(unsigned int band, Scratch& s){
+  unsigned int lo = edges[band];
+  unsigned int hi = edges[band + 1];
+  unsigned int n = s.fft.size();
+  //A perfect match has every bin of the band at phase 0, which the
+  // inverse transform (and the mirror image bins) turns into this peak
+  float scale = n/(2.0f*(hi - lo));
+  
+  float total = 0.0f;
+  for(unsigned int i=0; i < channels; i++){
+    for(unsigned int j=i+1; j < channels; j++){
+      const std::vector<std::complex<float> >& a = spectra[i];
+      const std::vector<std::complex<float> >& b = spectra[j];
+      for(unsigned int k=lo; k < hi; k++){
+	std::complex<float> cross = std::conj(a[k])*b[k];
+	float mag = std::abs(cross);
+	s.cross[k] = (mag > BAND_PHAT_EPSILON) ? cross/mag : 0.0f;
+      }
+      s.fft.inverse(s.cross.data(), s.corr.data());
+      //Leave the rest of the spectrum zero for the next band
+      std::fill(s.cross.begin() + lo, s.cross.begin() + hi, 0.0f);
+
+      //Negative lags wrap around to the end
+      for(int lag=-range; lag <= range; lag++){
+	s.curve[range + lag] = scale*s.corr[(lag + (int)n) % n];
+      }
+      std::pair<float, float> peak(0.0f, 0.0f);
+      curvePeaks(s.curve.data(), range, range, 1, subsample, &peak);
+      results[band][pairIndex(i, j, channels)] = -peak.first;
+      total += peak.second;
+    }
+  }
+  strengths[band] = total/numPairs(channels);
+}
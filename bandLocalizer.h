@@ -0,0 +1,178 @@
+/** \file bandLocalizer.h
+ * Delays between microphones measured separately in a few frequency
+ * bands, spread over several cores.
+ *
+ * On the full band signal a loud hum and a voice compete for the same
+ * correlation peak, and only the louder one is heard. Split into bands,
+ * the hum wins its band and the voice wins the others. Each band is GCC
+ * PHAT restricted to the FFT bins of that band, all from one shared
+ * transform of each channel. The bands are independent, so they are
+ * handed out to a small pool of worker threads, which the calling thread
+ * joins.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include "fft.h"
+#include "soundFrame.h"
+
+/*! Most bands the spectrum can be split into */
+constexpr unsigned int MAX_BANDS = 8;
+
+/*! Lower edge of the lowest band, in Hz. Everything below is DC and
+ *  rumble. */
+constexpr float BAND_LOW_HZ = 100.0f;
+
+/*! Bands quieter than this fraction of the loudest band, root mean
+ *  square, are not located. They would mostly be picking up the loud
+ *  band's leakage. */
+constexpr float MIN_BAND_SHARE = 0.1f;
+
+/*! Splits the spectrum from BAND_LOW_HZ to the Nyquist frequency into
+ *  bands of equal width on a log scale, and finds the delay of every
+ *  pair of channels in each band.
+ *
+ * Usage: call process once per window, then offsets, strength and level
+ * for each band. Nothing is allocated after construction.
+ */
+class BandLocalizer {
+ public:
+  /*! Allocate everything needed, and start the worker threads
+   *
+   * \param frames number of frames in each clip passed to process
+   * \param channels number of channels in each clip
+   * \param range largest delay to look for, in samples
+   * \param bands number of bands, from 1 to MAX_BANDS
+   * \param threads number of threads to spread the bands over, counting
+   *        the one that calls process. No more than bands are used.
+   */
+  BandLocalizer(unsigned int frames, unsigned int channels, int range,
+		unsigned int bands, unsigned int threads);
+
+  /*! Stops and joins the worker threads */
+  ~BandLocalizer();
+  
+  /*! Copy ctor deleted, the worker threads point back at this object */
+  BandLocalizer(BandLocalizer const&) = delete;
+  /*! Copy assignment deleted, the worker threads point back at this
+   *  object */
+  void operator=(BandLocalizer const&) = delete;
+
+  /*! Find the delays of every band of a new clip. Returns once all bands
+   *  are done.
+   *
+   * \param frame a sound clip of the size given to the constructor
+   * \param subsample refine delays with parabolicOffset
+   */
+  void process(const SoundFrame& frame, bool subsample);
+
+  /*! Number of bands */
+  unsigned int bands() const {
+    return numBands;
+  }
+
+  /*! Delays in one band, from the last call to process, as
+   *  offsets[pairIndex(i, j)]: t_i - t_j in samples, how much later the
+   *  sound reached channel i than channel j */
+  const std::vector<float>& offsets(unsigned int band) const {
+    return results[band];
+  }
+
+  /*! Mean PHAT peak height over all pairs in one band, from 0 to 1 */
+  float strength(unsigned int band) const {
+    return strengths[band];
+  }
+
+  /*! Root mean square of one band, averaged over channels, in the same
+   *  units as the samples */
+  float level(unsigned int band) const {
+    return levels[band];
+  }
+
+  /*! Lower edge of a band, in Hz. The upper edge is the lower edge of
+   *  the next band, or the Nyquist frequency for the last. */
+  float lowEdge(unsigned int band) const;
+  
+ private:
+  /*! What each thread needs of its own to work on a band */
+  struct Scratch {
+    explicit Scratch(unsigned int n, int range);
+    RealFFT fft;
+    std::vector<std::complex<float> > cross;
+    std::vector<float> corr;
+    std::vector<float> curve;
+  };
+
+  /*! Find the delays of one band */
+  void processBand(unsigned int band, Scratch& s);
+  /*! Take bands off the shared counter and process them until there are
+   *  none left */
+  void runBands(Scratch& s);
+  /*! Body of each worker thread */
+  void workerLoop(unsigned int id);
+
+  unsigned int frames;
+  unsigned int channels;
+  int range;
+  unsigned int numBands;
+  bool subsample;
+
+  RealFFT fft;
+  std::vector<float> timeScratch;
+  /*! One spectrum per channel, from the last call to process */
+  std::vector<std::vector<std::complex<float> > > spectra;
+  /*! First FFT bin of each band, plus one past the last bin of the last */
+  std::vector<unsigned int> edges;
+
+  std::vector<std::vector<float> > results;
+  std::vector<float> strengths;
+  std::vector<float> levels;
+
+  /*! One per thread, the calling thread's first */
+  std::vector<Scratch> scratch;
+  std::vector<std::thread> workers;
+  /*! Next band to hand out */
+  std::atomic<unsigned int> nextBand;
+  /*! Guards everything below */
+  std::mutex lock;
+  /*! Workers wait on this for a new clip, or for stopping */
+  std::condition_variable wake;
+  /*! process waits on this for the last band to finish */
+  std::condition_variable finished;
+  /*! Counts calls to process, so workers can tell a new clip has come */
+  unsigned long generation;
+  /*! Bands of the current clip not finished yet */
+  unsigned int pending;
+  bool stopping;
+};
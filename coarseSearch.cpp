@@ -0,0 +1,157 @@
+/** \file coarseSearch.cpp
+ * Coarse to fine delay search, see coarseSearch.h.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include "coarseSearch.h"
+#include "soundProcessing.h"
+#include "xcorrKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+CoarseSearch::CoarseSearch(int maxRange) :
+  frame(nullptr), coarseFrames(0),
+  sums(2*(maxRange + 2) + 1, 0),
+  coarseCorrs(2*(maxRange + 2) + 1, 0.0f),
+  corrs(2*(maxRange + 2) + 1, 0.0f),
+  computed(2*(maxRange + 2) + 1, 0) {
+  //More than any curve can have, so delay never allocates
+  peaks.reserve(2*(maxRange + 2) + 1);
+}
+
+void CoarseSearch::setFrame(const SoundFrame& iframe){
+  frame = &iframe;
+  coarseFrames = frame->frames()/COARSE_FACTOR;
+  coarse.resize(coarseFrames*frame->channels());
+  energy.resize(frame->channels());
+
+  for(unsigned int ch=0; ch < frame->channels(); ch++){
+    const int16_t* in = frame->samples(ch);
+    int16_t* out = coarse.data() + ch*coarseFrames;
+    //A box filter: the average of each run of COARSE_FACTOR samples
+    for(unsigned int i=0; i < coarseFrames; i++){
+      int32_t total = 0;
+      for(int k=0; k < COARSE_FACTOR; k++){
+	total += in[i*COARSE_FACTOR + k];
+      }
+      out[i] = (int16_t)(total/COARSE_FACTOR);
+    }
+
+    //A filter with one output is a dot product, which has a vector kernel
+    int64_t square;
+    firSums(in, in, frame->frames(), 1, 1, &square);
+    energy[ch] = (float)square/frame->frames();
+  }
+}
+
+void CoarseSearch::fineLags(unsigned int ch1, unsigned int ch2, int range,
+			    int lo, int hi){
+  unsigned int n = frame->frames();
+  xcorrSums(frame->samples(ch1), frame->samples(ch2), n, lo, hi - lo + 1,
+	    sums.data());
+  for(int lag=lo; lag <= hi; lag++){
+    corrs[lag + range] = (float)sums[lag - lo]/(n - std::abs(lag));
+    computed[lag + range] = 1;
+  }
+}
+
+std::pair<float, float> CoarseSearch::delay(unsigned int ch1,
+					    unsigned int ch2,
+					    int range,
+					    unsigned int candidates,
+					    bool subsample){
+  range += 2; //Same lags as delay() in soundProcessing.h
+  candidates = std::max(candidates, 1u);
+
+  //Coarse pass over every coarse lag that reaches the range
+  int coarseRange = (range + COARSE_FACTOR - 1)/COARSE_FACTOR;
+  const int16_t* x = coarse.data() + ch1*coarseFrames;
+  const int16_t* y = coarse.data() + ch2*coarseFrames;
+  xcorrSums(x, y, coarseFrames, -coarseRange, 2*coarseRange + 1,
+	    sums.data());
+  for(int lag=-coarseRange; lag <= coarseRange; lag++){
+    coarseCorrs[lag + coarseRange]
+      = (float)sums[lag + coarseRange]/(coarseFrames - std::abs(lag));
+  }
+
+  //The best local maxima of the coarse curve. There are only a handful of
+  // candidates, so keep them sorted by insertion.
+  peaks.clear();
+  for(int lag=-coarseRange; lag <= coarseRange; lag++){
+    float val = coarseCorrs[lag + coarseRange];
+    if((lag > -coarseRange && coarseCorrs[lag + coarseRange - 1] > val) ||
+       (lag < coarseRange && coarseCorrs[lag + coarseRange + 1] > val)){
+      continue;
+    }
+    unsigned int pos = peaks.size();
+    while(pos > 0 && coarseCorrs[peaks[pos - 1] + coarseRange] < val){
+      pos--;
+    }
+    if(pos < candidates){
+      if(peaks.size() == candidates){
+	peaks.pop_back();
+      }
+      peaks.insert(peaks.begin() + pos, lag);
+    }
+  }
+
+  //Fine pass within a coarse sample of each candidate. Stopping one lag
+  // short on the right makes it 2*COARSE_FACTOR lags, a whole number of
+  // the kernels' blocks of 4.
+  std::fill(computed.begin(), computed.begin() + 2*range + 1, 0);
+  for(int c : peaks){
+    fineLags(ch1, ch2, range, std::max(-range, (c - 1)*COARSE_FACTOR),
+	     std::min(range, (c + 1)*COARSE_FACTOR - 1));
+  }
+
+  //Same tie break as the exhaustive search: the lag closest to zero
+  int best = 0;
+  float bestVal = 0.0f;
+  bool found = false;
+  for(int lag=-range; lag <= range; lag++){
+    if(!computed[lag + range]) continue;
+    float val = corrs[lag + range];
+    if(!found || val > bestVal ||
+       (val == bestVal && std::abs(lag) < std::abs(best))){
+      best = lag;
+      bestVal = val;
+      found = true;
+    }
+  }
+
+  float lag = (float)best;
+  if(subsample && best > -range && best < range){
+    for(int l=best-1; l <= best+1; l+=2){
+      if(!computed[l + range]){
+	fineLags(ch1, ch2, range, l, l);
+      }
+    }
+    lag = best + parabolicOffset(corrs[best + range - 1], bestVal,
+				 corrs[best + range + 1]);
+  }
+  return std::make_pair(lag, bestVal/std::sqrt(energy[ch1]*energy[ch2]));
+}
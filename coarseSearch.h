@@ -0,0 +1,112 @@
+/** \file coarseSearch.h
+ * Coarse to fine search for the delay between two channels.
+ *
+ * The exhaustive search in delay() correlates every lag at the full
+ * sample rate. Here every channel is first averaged down by
+ * COARSE_FACTOR, which also low passes it, and correlated at every coarse
+ * lag, for about 1/COARSE_FACTOR^2 of the work. Only the lags around the
+ * best few coarse peaks are then correlated at the full rate.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+#include "soundFrame.h"
+
+/*! Samples averaged into each coarse sample. A compile time constant, so
+ *  the averaging is shifts rather than divides. */
+constexpr int COARSE_FACTOR = 4;
+
+/*! Coarse peaks refined at the full rate, unless told otherwise. More
+ *  candidates cost more, but catch a true peak that came second at the
+ *  coarse rate. */
+constexpr unsigned int COARSE_CANDIDATES = 2;
+
+/*! Coarse to fine delay estimation for one frame at a time
+ *
+ * Call setFrame once per frame, then delay for each pair wanted. If the
+ * true peak is among the refined candidates the answer is the same as
+ * the exhaustive delay(), bit for bit. Does not allocate after the first
+ * frame of a given size.
+ */
+class CoarseSearch {
+ public:
+  /*! Allocate room for the given range
+   *
+   * \param maxRange the largest range that will be passed to delay
+   */
+  explicit CoarseSearch(int maxRange);
+
+  /*! Make the coarse version of every channel, and note their energies
+   *
+   * \param frame the clip to search. Must stay unchanged while delay is
+   *        being called.
+   */
+  void setFrame(const SoundFrame& frame);
+
+  /*! Same result as delay(frame, ch1, ch2, range, ws, subsample) in
+   *  soundProcessing.h, when the true peak is one of the candidates
+   *
+   * \param ch1 first channel
+   * \param ch2 second channel
+   * \param range only test delays between -range-2 and range+2, as delay
+   *        does
+   * \param candidates how many coarse peaks to refine, at least 1
+   * \param subsample refine the delay with parabolicOffset
+   */
+  std::pair<float, float> delay(unsigned int ch1, unsigned int ch2,
+				int range, unsigned int candidates,
+				bool subsample = false);
+
+ private:
+  /*! Correlate ch1 and ch2 at full rate from lag lo to hi, inclusive, and
+   *  store the results in corrs */
+  void fineLags(unsigned int ch1, unsigned int ch2, int range, int lo,
+		int hi);
+  
+  /*! Frame from the last setFrame */
+  const SoundFrame* frame;
+  /*! Samples in each coarse channel */
+  unsigned int coarseFrames;
+  /*! Coarse channels, one after the other */
+  std::vector<int16_t> coarse;
+  /*! Mean square of each channel at the full rate */
+  std::vector<float> energy;
+  /*! Raw sums of one pass */
+  std::vector<int64_t> sums;
+  /*! Coarse correlations, one per coarse lag */
+  std::vector<float> coarseCorrs;
+  /*! Full rate correlations, corrs[range + o] for offset o. Only the lags
+   *  marked in computed are filled in. */
+  std::vector<float> corrs;
+  std::vector<char> computed;
+  /*! Coarse lags of the candidates, best first */
+  std::vector<int> peaks;
+};
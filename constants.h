@@ -37,17 +37,28 @@ constexpr float SENSOR_SPACING_INCHES = 7.0f;
 //Used here and locationlut.cpp
 constexpr float METERS_PER_INCH = 0.0254f;
 
-/*! Sample rate of the microphone we use 
-    \bug Should get this from the Microphone class, instead of hard coding it
+#ifndef SAMPLE_RATE
+/*! Processing sample rate, set at build time with make RATE=48000 */
+#define SAMPLE_RATE 16000
+#endif
+
+/*! Sample rate that delays are measured at. Higher rates give finer
+    delays, and so finer directions, but every stage after capture costs
+    more. The microphone may capture at a whole multiple of this, see
+    Settings::captureRate and Decimator.
 */
 //Used here and locationlut.cpp
-constexpr unsigned int SAMPLES_PER_SECOND = 16000;
+constexpr unsigned int SAMPLES_PER_SECOND = SAMPLE_RATE;
 
-/*! Number of channels coming from microphone 
-    \bug Should get this from the Microphone class, instead of hard coding it
+/*! Number of channels coming from the default microphone array. Arrays
+    loaded with --geometry set their own count at run time; see geometry.h.
+    4 channel clips still get the fastest code paths.
 */
 constexpr unsigned int NUM_CHANNELS = 4;
 
+/*! Most channels a microphone array described with --geometry may have */
+constexpr unsigned int MAX_CHANNELS = 16;
+
 /*! Speed of sound in seconds per meter*/
 //Used here and locationlut.cpp
 constexpr float SPEED_OF_SOUND_SECONDS_PER_METER = (float)(1.0/340.29);
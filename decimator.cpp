@@ -0,0 +1,122 @@
+/** \file decimator.cpp
+ * Polyphase low pass decimator, see decimator.h.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include "decimator.h"
+#include "xcorrKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+/*! Fixed point scale of the filter taps */
+constexpr int TAP_ONE = 1 << 15;
+
+Decimator::Decimator(unsigned int channels, unsigned int factor) :
+  factor(factor), channels(channels) {
+  if(factor < 1){
+    throw std::string("decimation factor must be at least 1");
+  }
+  if(factor == 1){
+    //Nothing to filter, process just copies
+    return;
+  }
+  
+  unsigned int len = DECIMATOR_TAPS_PER_PHASE*factor;
+  std::vector<double> h(len);
+  double center = (len - 1)/2.0;
+  double cutoff = 0.5/factor;
+  double total = 0.0;
+  for(unsigned int k=0; k < len; k++){
+    double t = k - center;
+    double sinc = t == 0.0 ? 2.0*cutoff
+      : std::sin(2.0*M_PI*cutoff*t)/(M_PI*t);
+    double w = 0.42 - 0.5*std::cos(2.0*M_PI*k/(len - 1))
+      + 0.08*std::cos(4.0*M_PI*k/(len - 1));
+    h[k] = sinc*w;
+    total += h[k];
+  }
+  for(unsigned int k=0; k < len; k++){
+    h[k] /= total;
+  }
+
+  //Round to Q15, then put the rounding error in the middle so the gain at
+  // DC is exactly 1. Two middle taps for an even length keeps the filter
+  // symmetric.
+  taps.resize(len);
+  int sum = 0;
+  for(unsigned int k=0; k < len; k++){
+    taps[k] = (int16_t)std::lround(h[k]*TAP_ONE);
+    sum += taps[k];
+  }
+  int err = TAP_ONE - sum;
+  if(len % 2 == 1){
+    taps[len/2] += err;
+  } else {
+    taps[len/2 - 1] += err/2;
+    taps[len/2] += err - err/2;
+  }
+}
+
+void Decimator::process(const std::vector<int16_t>& in,
+			std::vector<int16_t>& out){
+  if(factor == 1){
+    out = in;
+    return;
+  }
+  
+  unsigned int inFrames = in.size()/channels;
+  if(inFrames % factor != 0){
+    throw std::string("period of ") + std::to_string(inFrames)
+      + " frames is not a multiple of the decimation factor "
+      + std::to_string(factor);
+  }
+  unsigned int outFrames = inFrames/factor;
+  unsigned int history = taps.size() - 1;
+  unsigned int stride = history + inFrames;
+  if(planar.size() != channels*stride){
+    //New period size. Start over from silence.
+    planar.assign(channels*stride, 0);
+  }
+  sums.resize(outFrames);
+  out.resize(outFrames*channels);
+
+  for(unsigned int ch=0; ch < channels; ch++){
+    int16_t* x = planar.data() + ch*stride;
+    //Last period's tail becomes this period's history
+    std::copy(x + inFrames, x + stride, x);
+    std::copy(in.begin() + ch*inFrames, in.begin() + (ch + 1)*inFrames,
+	      x + history);
+
+    firSums(x, taps.data(), taps.size(), factor, outFrames, sums.data());
+    for(unsigned int n=0; n < outFrames; n++){
+      int64_t v = (sums[n] + TAP_ONE/2) >> 15;
+      out[ch*outFrames + n] = (int16_t)std::max<int64_t>(INT16_MIN,
+					   std::min<int64_t>(INT16_MAX, v));
+    }
+  }
+}
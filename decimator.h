@@ -0,0 +1,88 @@
+/** \file decimator.h
+ * Lowers the sample rate of captured audio by a whole number factor.
+ *
+ * Capturing at 48 or 96 kHz and decimating keeps the delay estimation
+ * cost of a lower processing rate, while the low pass filter band limits
+ * the signal properly first, so nothing above the new Nyquist frequency
+ * aliases back in.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+/*! Number of filter taps per output sample. The filter is this many times
+ *  the decimation factor long. */
+constexpr unsigned int DECIMATOR_TAPS_PER_PHASE = 24;
+
+/*! Polyphase low pass decimator for 16 bit audio, one channel after the
+ *  other
+ *
+ * The filter is a Blackman windowed sinc with its cutoff at the output
+ * Nyquist frequency, in Q15 fixed point, so the vectorized firSums gives
+ * the same answer as plain C++. It is symmetric, so every channel is
+ * delayed by the same (taps-1)/2 input samples and the delays between
+ * channels are unchanged. The last taps-1 samples of each channel are
+ * kept from one call to the next, so consecutive periods are filtered as
+ * one continuous signal.
+ */
+class Decimator {
+ public:
+  /*! \param channels number of channels
+   *  \param factor input samples per output sample, at least 1
+   */
+  Decimator(unsigned int channels, unsigned int factor);
+
+  /*! Filter and decimate one period
+   *
+   * \param in samples at the input rate, channel ch at
+   *        [ch*frames, (ch+1)*frames). The number of frames must be a
+   *        multiple of factor.
+   * \param out receives in.size()/factor samples at the output rate, laid
+   *        out the same way. Doesn't allocate once out has the right
+   *        size.
+   *
+   * \note Throws a std::string if the period isn't a multiple of factor
+   */
+  void process(const std::vector<int16_t>& in, std::vector<int16_t>& out);
+
+  /*! Input samples per output sample */
+  const unsigned int factor;
+  /*! Number of channels */
+  const unsigned int channels;
+  
+ private:
+  /*! Filter coefficients, in Q15. They add up to exactly 1. Empty if
+   *  factor is 1. */
+  std::vector<int16_t> taps;
+  /*! For each channel, taps.size()-1 samples of history followed by the
+   *  current period */
+  std::vector<int16_t> planar;
+  /*! Raw filter sums for one channel of one period */
+  std::vector<int64_t> sums;
+};
@@ -0,0 +1,139 @@
+/** \file fft.cpp
+ * Small radix-2 FFT for real signals, used by the frequency domain
+ * delay estimators.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include "fft.h"
+
+#include <cmath>
+#include <string>
+
+constexpr double PI = 3.14159265358979323846;
+
+unsigned int RealFFT::nextPow2(unsigned int n){
+  unsigned int ret = 1;
+  while(ret < n){
+    ret *= 2;
+  }
+  return ret;
+}
+
+RealFFT::RealFFT(unsigned int in) : n(in) {
+  if(n < 4 || (n & (n-1)) != 0){
+    throw std::string("FFT length must be a power of two, at least 4");
+  }
+  
+  unsigned int m = n/2;
+  twiddles.resize(m/2);
+  for(unsigned int k=0; k < m/2; k++){
+    twiddles[k] = std::polar(1.0f, (float)(-2.0*PI*k/m));
+  }
+
+  realTwiddles.resize(m);
+  for(unsigned int k=0; k < m; k++){
+    realTwiddles[k] = std::polar(1.0f, (float)(-2.0*PI*k/n));
+  }
+
+  unsigned int bits = 0;
+  while((1u << bits) < m) bits++;
+  bitrev.resize(m);
+  for(unsigned int i=0; i < m; i++){
+    unsigned int r = 0;
+    for(unsigned int b=0; b < bits; b++){
+      if(i & (1u << b)) r |= 1u << (bits - 1 - b);
+    }
+    bitrev[i] = r;
+  }
+
+  work.resize(m);
+}
+
+unsigned int RealFFT::size() const {
+  return n;
+}
+
+void RealFFT::complexFFT(bool inverse) const {
+  unsigned int m = n/2;
+  for(unsigned int i=0; i < m; i++){
+    if(i < bitrev[i]){
+      std::swap(work[i], work[bitrev[i]]);
+    }
+  }
+
+  for(unsigned int len=2; len <= m; len *= 2){
+    unsigned int half = len/2;
+    unsigned int step = m/len;
+    for(unsigned int start=0; start < m; start += len){
+      for(unsigned int k=0; k < half; k++){
+	std::complex<float> w = twiddles[k*step];
+	if(inverse) w = std::conj(w);
+	std::complex<float> a = work[start + k];
+	std::complex<float> b = work[start + k + half] * w;
+	work[start + k] = a + b;
+	work[start + k + half] = a - b;
+      }
+    }
+  }
+}
+
+void RealFFT::forward(const float* in, std::complex<float>* out) const {
+  unsigned int m = n/2;
+  //Pack even samples into the real part, odd into the imaginary part
+  for(unsigned int k=0; k < m; k++){
+    work[k] = std::complex<float>(in[2*k], in[2*k+1]);
+  }
+  complexFFT(false);
+
+  //Separate the spectra of the even and odd samples, then combine them
+  out[0] = std::complex<float>(work[0].real() + work[0].imag(), 0.0f);
+  out[m] = std::complex<float>(work[0].real() - work[0].imag(), 0.0f);
+  for(unsigned int k=1; k < m; k++){
+    std::complex<float> z = work[k];
+    std::complex<float> zc = std::conj(work[m-k]);
+    std::complex<float> even = 0.5f*(z + zc);
+    std::complex<float> odd = std::complex<float>(0.0f, -0.5f)*(z - zc);
+    out[k] = even + realTwiddles[k]*odd;
+  }
+}
+
+void RealFFT::inverse(const std::complex<float>* in, float* out) const {
+  unsigned int m = n/2;
+  for(unsigned int k=0; k < m; k++){
+    std::complex<float> x = in[k];
+    std::complex<float> xc = std::conj(in[m-k]);
+    std::complex<float> even = 0.5f*(x + xc);
+    std::complex<float> odd = 0.5f*(x - xc)*std::conj(realTwiddles[k]);
+    work[k] = even + std::complex<float>(0.0f, 1.0f)*odd;
+  }
+  complexFFT(true);
+
+  float scale = 1.0f/m;
+  for(unsigned int k=0; k < m; k++){
+    out[2*k] = work[k].real()*scale;
+    out[2*k+1] = work[k].imag()*scale;
+  }
+}
@@ -0,0 +1,86 @@
+/** \file fft.h
+ * Small radix-2 FFT for real signals, used by the frequency domain
+ * delay estimators.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#pragma once
+
+#include <vector>
+#include <complex>
+
+/*! Forward and inverse FFT of a real signal whose length is a power of two.
+ *
+ * A length n real signal is packed into a length n/2 complex signal, which
+ * is transformed and then unpacked, so each transform costs about half of
+ * a complex FFT of the same length. Twiddle factors and the bit reversal
+ * permutation are computed once, in the constructor.
+ *
+ * \note Uses an internal scratch buffer, so a RealFFT must not be shared
+ * between threads. Make one per thread instead.
+ */
+class RealFFT {
+ public:
+  /*! Prepare tables for transforms of length n
+   *
+   * \param n signal length. Must be a power of two, at least 4.
+   */
+  explicit RealFFT(unsigned int n);
+
+  /*! Length of the real signal this object transforms */
+  unsigned int size() const;
+
+  /*! Compute the spectrum of a real signal
+   *
+   * \param in n real samples
+   * \param out receives the n/2+1 non-redundant bins, from DC to Nyquist
+   */
+  void forward(const float* in, std::complex<float>* out) const;
+
+  /*! Compute the real signal that has the given spectrum. forward followed
+   *  by inverse returns the original signal (it is scaled by 1/n).
+   *
+   * \param in n/2+1 bins, from DC to Nyquist
+   * \param out receives n real samples
+   */
+  void inverse(const std::complex<float>* in, float* out) const;
+
+  /*! Smallest power of two that is at least n */
+  static unsigned int nextPow2(unsigned int n);
+
+ private:
+  /*! In place complex FFT of length n/2, on the contents of work */
+  void complexFFT(bool inverse) const;
+
+  unsigned int n;
+  /*! exp(-2 pi i k/(n/2)), for the half length complex FFT */
+  std::vector<std::complex<float> > twiddles;
+  /*! exp(-2 pi i k/n), for packing and unpacking the real signal */
+  std::vector<std::complex<float> > realTwiddles;
+  /*! Bit reversal permutation of the indices 0..n/2-1 */
+  std::vector<unsigned int> bitrev;
+  mutable std::vector<std::complex<float> > work;
+};
@@ -0,0 +1,103 @@
+/** \file frameRing.cpp
+ * Lock-free single-producer/single-consumer ring of captured periods,
+ * used to hand sound data from the capture thread to the processing loop.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include "frameRing.h"
+
+#include <chrono>
+
+//One slot is always left empty, so that head == tail means "empty" and
+// never "full"
+FrameRing::FrameRing(std::size_t numSlots, std::size_t samplesPerSlot) :
+  slots(numSlots+1, std::vector<int16_t>(samplesPerSlot, 0)),
+  head(0), tail(0), waiting(false), interrupted(false) {
+}
+
+std::vector<int16_t>* FrameRing::writeSlot(){
+  std::size_t h = head.load(std::memory_order_relaxed);
+  std::size_t next = (h + 1) % slots.size();
+  if(next == tail.load(std::memory_order_acquire)){
+    return nullptr;
+  }
+  return &slots[h];
+}
+
+void FrameRing::commitWrite(){
+  std::size_t h = head.load(std::memory_order_relaxed);
+  //Sequentially consistent, like the consumer's store to waiting, so
+  // either we see that it is waiting or it sees the new head before it
+  // sleeps. Most of the time nobody is waiting and this is all we do.
+  head.store((h + 1) % slots.size(), std::memory_order_seq_cst);
+  if(!waiting.load(std::memory_order_seq_cst)) return;
+
+  //Taking the lock here, even though we don't touch anything it guards,
+  // makes sure a consumer that said it is waiting is already asleep
+  // before we notify it.
+  { std::lock_guard<std::mutex> guard(wakeMutex); }
+  wake.notify_one();
+}
+
+bool FrameRing::pop(std::vector<int16_t>& out, unsigned int timeoutMs){
+  std::size_t t = tail.load(std::memory_order_relaxed);
+  
+  if(t == head.load(std::memory_order_acquire)){
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    waiting.store(true, std::memory_order_seq_cst);
+    wake.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+		  [&]{
+		    return interrupted.load(std::memory_order_relaxed)
+		      || t != head.load(std::memory_order_seq_cst);
+		  });
+    waiting.store(false, std::memory_order_relaxed);
+    interrupted.store(false, std::memory_order_relaxed);
+    if(t == head.load(std::memory_order_acquire)) return false;
+  }
+
+  out.swap(slots[t]);
+  tail.store((t + 1) % slots.size(), std::memory_order_release);
+  return true;
+}
+
+void FrameRing::wakeConsumer(){
+  //Only called when capture stops, so it can afford the lock every time
+  {
+    std::lock_guard<std::mutex> guard(wakeMutex);
+    interrupted.store(true, std::memory_order_relaxed);
+  }
+  wake.notify_all();
+}
+
+std::size_t FrameRing::occupancy() const {
+  std::size_t h = head.load(std::memory_order_acquire);
+  std::size_t t = tail.load(std::memory_order_acquire);
+  return (h + slots.size() - t) % slots.size();
+}
+
+std::size_t FrameRing::capacity() const {
+  return slots.size() - 1;
+}
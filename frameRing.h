@@ -0,0 +1,120 @@
+/** \file frameRing.h
+ * Lock-free single-producer/single-consumer ring of captured periods,
+ * used to hand sound data from the capture thread to the processing loop.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+/*! Counters describing the health of the capture thread. A snapshot of
+ *  these is handed to the Server so they can be inspected remotely. */
+struct CaptureStats {
+  /*! Number of periods waiting in the ring to be processed */
+  std::size_t   occupancy = 0;
+  /*! Number of slots in the ring */
+  std::size_t   capacity = 0;
+  /*! Number of periods successfully read from the microphone */
+  unsigned long captured = 0;
+  /*! Number of times ALSA reported an overrun (-EPIPE) */
+  unsigned long overruns = 0;
+  /*! Number of periods read from ALSA but thrown away because the
+   *  processing loop had not emptied the ring */
+  unsigned long dropped = 0;
+};
+
+/*! Fixed size ring of sound periods, with one producer (the capture thread)
+ *  and one consumer (the main processing loop).
+ *
+ * All slots are allocated up front and are the same size. The consumer
+ * receives data by swapping its own buffer with the slot, so handing
+ * off a period never copies or allocates.
+ *
+ * \note Only the wakeup of a sleeping consumer uses a mutex, and the
+ * producer only takes it when the consumer has said it is asleep. Moving
+ * data through the ring is lock-free.
+ */
+class FrameRing {
+ public:
+  /*! Allocate the ring
+   *
+   * \param numSlots how many periods the ring can hold
+   * \param samplesPerSlot size of each period, in samples (frames*channels)
+   */
+  FrameRing(std::size_t numSlots, std::size_t samplesPerSlot);
+
+  /*! Producer side: get the next free slot to fill.
+   *
+   * \return the slot, or nullptr if the ring is full
+   */
+  std::vector<int16_t>* writeSlot();
+
+  /*! Producer side: publish the slot returned by writeSlot, making it
+   *  visible to the consumer */
+  void commitWrite();
+
+  /*! Consumer side: take the oldest period out of the ring, waiting for
+   *  one to arrive if the ring is empty.
+   *
+   * \param out receives the period. Must be the same size as the slots,
+   *            its old contents are swapped into the ring for reuse.
+   * \param timeoutMs give up after this many milliseconds
+   * \return false if no period arrived before the timeout
+   */
+  bool pop(std::vector<int16_t>& out, unsigned int timeoutMs);
+
+  /*! Wake up a consumer that is blocked in pop, for example on shutdown */
+  void wakeConsumer();
+  
+  /*! Number of periods currently waiting to be consumed */
+  std::size_t occupancy() const;
+  /*! Total number of slots in the ring */
+  std::size_t capacity() const;
+
+ private:
+  std::vector<std::vector<int16_t> > slots;
+
+  /*! Next slot to be written. Only modified by the producer */
+  std::atomic<std::size_t> head;
+  /*! Next slot to be read. Only modified by the consumer */
+  std::atomic<std::size_t> tail;
+
+  /*! Set by the consumer while it sleeps in pop, so the producer knows
+   *  whether it has to wake it */
+  std::atomic<bool> waiting;
+  /*! Set by wakeConsumer, so pop gives up before its timeout. Guarded by
+   *  wakeMutex */
+  std::atomic<bool> interrupted;
+
+  std::mutex wakeMutex;
+  std::condition_variable wake;
+};
@@ -0,0 +1,146 @@
+/** \file gccPhat.cpp
+ * Frequency domain (generalized cross correlation) delay estimation.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include "gccPhat.h"
+#include "soundProcessing.h"
+
+#include <cmath>
+#include <algorithm>
+
+/*! Spectrum magnitudes smaller than this are treated as zero when
+ *  applying PHAT weighting, so silent bins don't blow up */
+constexpr float PHAT_EPSILON = 1e-6f;
+
+GccPhat::GccPhat(unsigned int iframes, unsigned int ichannels, int maxRange,
+		 bool usePhat) :
+  frames(iframes), channels(ichannels), phat(usePhat),
+  //Pad so that lags up to maxRange don't wrap around onto each other
+  fft(RealFFT::nextPow2(iframes + std::abs(maxRange) + 1)),
+  spectra(ichannels,
+	  std::vector<std::complex<float> >(fft.size()/2 + 1)),
+  energy(ichannels, 0.0f),
+  timeScratch(fft.size(), 0.0f),
+  crossScratch(fft.size()/2 + 1),
+  corr(fft.size(), 0.0f) {
+}
+
+void GccPhat::setFrame(const SoundFrame& frame){
+  for(unsigned int ch=0; ch < channels; ch++){
+    const float* in = frame.floats(ch);
+    float total = 0.0f;
+    for(unsigned int i=0; i < frames; i++){
+      float val = in[i];
+      timeScratch[i] = val;
+      total += val*val;
+    }
+    //The rest is zero padding, which never gets overwritten
+    energy[ch] = total/frames;
+    fft.forward(timeScratch.data(), spectra[ch].data());
+  }
+}
+
+void GccPhat::correlate(unsigned int ch1, unsigned int ch2){
+  const std::vector<std::complex<float> >& a = spectra[ch1];
+  const std::vector<std::complex<float> >& b = spectra[ch2];
+
+  for(unsigned int k=0; k < crossScratch.size(); k++){
+    std::complex<float> cross = std::conj(a[k])*b[k];
+    if(phat){
+      float mag = std::abs(cross);
+      cross = (mag > PHAT_EPSILON) ? cross/mag : 0.0f;
+    }
+    crossScratch[k] = cross;
+  }
+  if(phat){
+    //DC carries no timing information, just microphone bias
+    crossScratch[0] = 0.0f;
+  }
+
+  fft.inverse(crossScratch.data(), corr.data());
+}
+
+float GccPhat::corrAt(int lag) const {
+  float val = corr[(lag + (int)corr.size()) % corr.size()];
+  if(phat){
+    return val;
+  }
+  //Match dotWithOffset, which averages over the overlapping samples
+  return val/(frames - std::abs(lag));
+}
+
+std::vector<std::pair<float, float> >
+GccPhat::xcorr(unsigned int ch1, unsigned int ch2, int range){
+  correlate(ch1, ch2);
+  
+  std::vector<std::pair<float, float> > ret;
+  for(int offset=-range; offset <= range; offset++){
+    ret.push_back(std::make_pair(offset, corrAt(offset)));
+  }
+  return ret;
+}
+
+std::pair<float, float>
+GccPhat::delay(unsigned int ch1, unsigned int ch2, int range,
+	       bool subsample){
+  correlate(ch1, ch2);
+
+  //Same search as delay() in soundProcessing.cpp: widest range first,
+  // ties go to the smaller lag
+  range += 2;
+  int maxLag = -range;
+  float maxVal = corrAt(-range);
+  for(int lag=-range+1; lag <= range; lag++){
+    float val = corrAt(lag);
+    if(val > maxVal || (val == maxVal && std::abs(lag) < std::abs(maxLag))){
+      maxVal = val;
+      maxLag = lag;
+    }
+  }
+
+  float lag = (float)maxLag;
+  if(subsample && maxLag > -range && maxLag < range){
+    lag += parabolicOffset(corrAt(maxLag - 1), maxVal, corrAt(maxLag + 1));
+  }
+
+  if(phat){
+    return std::make_pair(lag, maxVal);
+  }
+  return std::make_pair(lag, maxVal/std::sqrt(energy[ch1]*energy[ch2]));
+}
+
+void GccPhat::curve(unsigned int ch1, unsigned int ch2, int range,
+		    float* out){
+  correlate(ch1, ch2);
+
+  //A silent channel matches nothing
+  float norm = std::sqrt(energy[ch1]*energy[ch2]);
+  float scale = phat ? 1.0f : (norm > 0.0f ? 1.0f/norm : 0.0f);
+  for(int lag=-range; lag <= range; lag++){
+    out[range + lag] = corrAt(lag)*scale;
+  }
+}
@@ -0,0 +1,120 @@
+/** \file gccPhat.h
+ * Frequency domain (generalized cross correlation) delay estimation.
+ *
+ * An alternative to xcorr and delay in soundProcessing.h. Instead of
+ * computing one dot product per lag, each channel is transformed once
+ * per frame, and each pair of channels costs one multiply of spectra and
+ * one inverse transform, no matter how many lags are needed.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <cstdint>
+
+#include "fft.h"
+#include "soundFrame.h"
+
+/*! Cross correlation of sound channels through the FFT, with optional
+ *  PHAT (phase transform) weighting.
+ *
+ * Without PHAT weighting the results match xcorr and delay from
+ * soundProcessing.h, up to float rounding. With PHAT weighting every
+ * frequency counts equally, which gives much sharper peaks when there is
+ * reverb, but the correlation values are no longer energies. A perfect
+ * match scores 1.0.
+ *
+ * Usage: call setFrame once per frame, then xcorr or delay for as many
+ * pairs as are needed.
+ */
+class GccPhat {
+ public:
+  /*! Allocate everything needed for frames of a fixed size
+   *
+   * \param frames number of frames in each clip passed to setFrame
+   * \param channels number of channels in each clip
+   * \param maxRange largest lag that will be asked for, in samples. Sets
+   *        the zero padding needed to avoid circular wrap-around.
+   * \param usePhat true for PHAT weighting, false for plain cross
+   *        correlation
+   */
+  GccPhat(unsigned int frames, unsigned int channels, int maxRange,
+	  bool usePhat);
+
+  /*! Transform every channel of a new sound clip
+   *
+   * \param frame a sound clip of the size given to the constructor
+   */
+  void setFrame(const SoundFrame& frame);
+
+  /*! Same as xcorr in soundProcessing.h, but for the clip given to the
+   *  last call to setFrame */
+  std::vector<std::pair<float, float> >
+  xcorr(unsigned int ch1, unsigned int ch2, int range);
+
+  /*! Same as delay in soundProcessing.h, but for the clip given to the
+   *  last call to setFrame. If subsample is true the delay is refined
+   *  with parabolicOffset. */
+  std::pair<float, float>
+  delay(unsigned int ch1, unsigned int ch2, int range,
+	bool subsample = false);
+
+  /*! Correlation curve of one pair, for the clip given to the last call
+   *  to setFrame, normalized like the score delay returns, so a perfect
+   *  match is 1.0
+   *
+   * \param ch1 first channel
+   * \param ch2 second channel
+   * \param range largest offset to fill in
+   * \param out receives 2*range+1 values. out[range + o] is for offset o.
+   */
+  void curve(unsigned int ch1, unsigned int ch2, int range, float* out);
+
+ private:
+  /*! Fill corr with the correlation of ch1 and ch2, for every lag.
+   *  Negative lags wrap around to the end of the array. */
+  void correlate(unsigned int ch1, unsigned int ch2);
+  
+  /*! Correlation at one lag, after correlate has been called */
+  float corrAt(int lag) const;
+  
+  unsigned int frames;
+  unsigned int channels;
+  bool phat;
+  
+  RealFFT fft;
+  
+  /*! One spectrum per channel, from the last call to setFrame */
+  std::vector<std::vector<std::complex<float> > > spectra;
+  /*! Mean square of each channel, for normalizing delay results */
+  std::vector<float> energy;
+
+  std::vector<float> timeScratch;
+  std::vector<std::complex<float> > crossScratch;
+  std::vector<float> corr;
+};
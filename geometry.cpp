@@ -0,0 +1,92 @@
+/** \file geometry.cpp
+ * Where the microphones are.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+
+#include "geometry.h"
+#include "utils.h"
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+/*! Sensor spacing converted to meters */
+constexpr float SENSOR_SPACING_METERS = SENSOR_SPACING_INCHES*METERS_PER_INCH;
+
+/*! sin of 60 degrees */
+constexpr float SIN_60 = 0.86602540378f;
+/*! tan of 60 degrees */
+constexpr float TAN_60 = 1.73205080757f;
+
+std::vector<std::vector<float> > MIC_LOCATIONS =
+  {
+    {0.0f, SENSOR_SPACING_METERS/(2*SIN_60), 0.0f}, //Front
+    {-SENSOR_SPACING_METERS/2, -SENSOR_SPACING_METERS/(2*TAN_60), 0.0f}, //L
+    { SENSOR_SPACING_METERS/2, -SENSOR_SPACING_METERS/(2*TAN_60), 0.0f}, //R
+    {0.0f, 0.0f, SENSOR_SPACING_METERS}  //Up
+  };
+
+void loadMicLocations(const std::string& fname){
+  std::ifstream infile(fname);
+  if(!infile.is_open()){
+    throw std::string("unable to open geometry file: ") + fname;
+  }
+
+  std::vector<std::vector<float> > mics;
+  std::string line;
+  int lineNumber = 0;
+  while(std::getline(infile, line)){
+    lineNumber++;
+    line = line.substr(0, line.find('#'));
+    if(line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+    std::istringstream fields(line);
+    std::vector<float> mic(3);
+    std::string extra;
+    if(!(fields >> mic[0] >> mic[1] >> mic[2]) || (fields >> extra)){
+      throw fname + ":" + std::to_string(lineNumber)
+	+ ": expected x y z in meters";
+    }
+    mics.push_back(mic);
+  }
+
+  if(mics.size() < 4 || mics.size() > MAX_CHANNELS){
+    throw fname + ": need between 4 and " + std::to_string(MAX_CHANNELS)
+      + " microphones, found " + std::to_string(mics.size());
+  }
+  MIC_LOCATIONS = mics;
+}
+
+float maxMicDelay(){
+  float ret = 0.0f;
+  for(unsigned int i=0; i < MIC_LOCATIONS.size(); i++){
+    for(unsigned int j=i+1; j < MIC_LOCATIONS.size(); j++){
+      ret = std::max(ret, dist(MIC_LOCATIONS[i], MIC_LOCATIONS[j]));
+    }
+  }
+  return ret*SPEED_OF_SOUND_SAMPLES_PER_METER;
+}
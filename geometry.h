@@ -0,0 +1,67 @@
+/** \file geometry.h
+ * Where the microphones are.
+ *
+ * The default is the original 4 mic tetrahedron. Other arrays are
+ * described in a text file given with --geometry=FILE, and the number of
+ * microphones in it sets the number of channels captured.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "constants.h"
+
+/*! Speed of sound in terms of how many microphone samples elapse as sound
+ * travels one meter */
+constexpr float SPEED_OF_SOUND_SAMPLES_PER_METER = SAMPLES_PER_SECOND *
+  SPEED_OF_SOUND_SECONDS_PER_METER;
+
+/*! Locations of the microphones relative to the origin, in meters, one per
+ *  channel.
+ *
+ * By default, microphones form a tetrahedron, with three mics in a plane
+ * parallel to the ground, and one mic above them. The origin is in the
+ * plane parallel to the ground, directly under the "up" mic.
+ */
+extern std::vector<std::vector<float> > MIC_LOCATIONS;
+
+/*! Replace MIC_LOCATIONS with the positions listed in a file
+ *
+ * \param fname file with one microphone per line, as x y z in meters, in
+ *        channel order. Blank lines and anything after a # are ignored.
+ *
+ * \note Throws a std::string if the file can't be read, or doesn't have
+ *       between 4 and MAX_CHANNELS microphones
+ */
+void loadMicLocations(const std::string& fname);
+
+/*! Largest distance between any two microphones, in samples. Delays
+ *  between channels can't be longer than this. */
+float maxMicDelay();
@@ -43,36 +43,73 @@
 #include <fstream>
 #include <vector>
 #include <cmath>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <cstddef>
+#include <thread>
 
-/*! Sensor spacing converted to meters */
-constexpr float SENSOR_SPACING_METERS = SENSOR_SPACING_INCHES*METERS_PER_INCH;
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
-/*! Speed of sound in terms of how many microphone samples elapse as sound
- * travels one meter */
-constexpr float SPEED_OF_SOUND_SAMPLES_PER_METER = SAMPLES_PER_SECOND *
-  SPEED_OF_SOUND_SECONDS_PER_METER;
+/*! Name of file for caching the lookup table */
+constexpr char FNAME[] = "lut.bin";
 
-/*! sin of 60 degrees */
-constexpr float SIN_60 = 0.86602540378f;
-/*! tan of 60 degrees */
-constexpr float TAN_60 = 1.73205080757f;
+/*! First bytes of every cache file */
+constexpr char LUT_MAGIC[8] = {'S', 'L', 'A', '-', 'L', 'U', 'T', '\0'};
+/*! Bump whenever the layout of the cache file changes */
+constexpr uint32_t LUT_VERSION = 2;
+/*! Written as a native integer, so a file from a machine with the other
+ *  byte order doesn't match */
+constexpr uint32_t LUT_BYTE_ORDER = 0x01020304;
 
-/*! Locations of the 4 microphones relative to the origin, in meters.
+/*! Start of the cache file. Followed by the populated entries of packed,
+ *  the populated indices of packedCells and then the
+ *  LUT_FILL_CELLS_PER_AXIS^3 indices of nearest, exactly as they are laid
+ *  out in memory.
  *
- * Microphones form a tetrahedron, with three mics in a plane parallel
- * to the ground, and one mic above them. The origin is in the plane parallel
- * to the ground, directly under the "up" mic.
+ *  Everything up to populated describes what the table was built for, and
+ *  has to match the running program for the file to be used.
  */
-std::vector<std::vector<float> > MIC_LOCATIONS =
-  {
-    {0.0f, SENSOR_SPACING_METERS/(2*SIN_60), 0.0f}, //Front
-    {-SENSOR_SPACING_METERS/2, -SENSOR_SPACING_METERS/(2*TAN_60), 0.0f}, //L
-    { SENSOR_SPACING_METERS/2, -SENSOR_SPACING_METERS/(2*TAN_60), 0.0f}, //R
-    {0.0f, 0.0f, SENSOR_SPACING_METERS}  //Up
-  };
+struct LUTFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byteOrder;
+  uint32_t headerBytes;
+  uint32_t sampleRate;
+  float micLocations[4][3];
+  float keyPrec;
+  int32_t minOffset;
+  int32_t maxOffset;
+  int32_t fillTicks;
+  uint32_t cellsPerAxis;
+  uint32_t fillCellsPerAxis;
+  uint32_t populated;
+  uint32_t unused;
+  //! FNV-1a hash of everything after the header
+  uint64_t checksum;
+};
+//Keeps the tables after it 16 byte aligned
+static_assert(sizeof(LUTFileHeader) % 16 == 0, "LUTFileHeader size");
 
-/*! Name of file for caching the lookup table */
-constexpr char FNAME[] = "lut.csv";
+/*! Bytes of nearest at the end of the file */
+constexpr size_t LUT_FILL_BYTES = sizeof(uint16_t)*LUT_FILL_CELLS_PER_AXIS
+  *LUT_FILL_CELLS_PER_AXIS*LUT_FILL_CELLS_PER_AXIS;
+
+/*! Bytes of packed and packedCells for a table with this many entries */
+size_t lutEntryBytes(unsigned int populated){
+  return (sizeof(PackedLUTEntry) + sizeof(uint32_t))*populated;
+}
+
+/*! A delay as a whole number of steps of 1/LUT_KEY_PREC, halves rounded
+ *  away from zero. Both building the table and looking a key up go
+ *  through this, so a delay exactly between two keys lands in the same
+ *  cell either way. */
+static float keyTicks(float delay){
+  return std::round(LUT_KEY_PREC*delay);
+}
 
 /*! Given a location in world coordinates, calculate the microphone
  *  delay offsets for mics 1, 2, and 3.
@@ -86,179 +123,456 @@ std::vector<float> offsetsForLocation(std::vector<float> pt){
   }
   
   std::vector<float> ret = {
-    (float)round(LUT_KEY_PREC*((micDists[0] - micDists[1])
-			 *SPEED_OF_SOUND_SAMPLES_PER_METER))/LUT_KEY_PREC,
-     (float)round(LUT_KEY_PREC*((micDists[0] - micDists[2])
-			 *SPEED_OF_SOUND_SAMPLES_PER_METER))/LUT_KEY_PREC,
-     (float)round(LUT_KEY_PREC*((micDists[0] - micDists[3])
-			 *SPEED_OF_SOUND_SAMPLES_PER_METER))/LUT_KEY_PREC};
+    keyTicks((micDists[0] - micDists[1])
+	     *SPEED_OF_SOUND_SAMPLES_PER_METER)/LUT_KEY_PREC,
+    keyTicks((micDists[0] - micDists[2])
+	     *SPEED_OF_SOUND_SAMPLES_PER_METER)/LUT_KEY_PREC,
+    keyTicks((micDists[0] - micDists[3])
+	     *SPEED_OF_SOUND_SAMPLES_PER_METER)/LUT_KEY_PREC};
 
   return ret;
 }
 
-void LocationLUT::buildLUT(){
-  /* First, generate a big list of points */
-  std::unordered_map<std::vector<float>,
-    std::vector<std::vector<float>>,
-    key_hash> found_points;
-  
-  static std::vector<float> center = {0.0f, 0.0f, 0.0f};
+/*! What an empty cell of the table holds, and what get returns when
+ *  it can't find anything */
+const LUTEntry EMPTY_ENTRY = {10.0f, 10.0f, 10.0f, -1.0f};
 
-  //A sphere with 64k points on it, each point should be spaced
-  // about one degree apart
-  std::vector<std::vector<float> > pts = genPoints(256*256);
+/*! Scale of the fixed point directions in PackedLUTEntry */
+constexpr float PACKED_DIR_SCALE = 32767.0f;
 
-  float scale = 1.5;
-  
-  for(int i=0; i<pts.size(); i++){
-    std::vector<float> pt
-      = {scale*pts[i][0], scale*pts[i][1], scale*pts[i][2]};
-    
-    //Don't worry about noises right next to the person
-    if(dist(center, pt) < 0.05) continue;
-	
-    std::vector<float> offsets = offsetsForLocation(pt);
-    
-    if(found_points.count(offsets) == 0){
-      std::vector<std::vector<float>> t;
-      //Add empty tuple, to modify in a sec
-      found_points.insert(std::make_pair(offsets, t));
+/*! A header describing the table this program would build, with
+ *  populated and checksum left as 0 */
+LUTFileHeader currentHeader(){
+  LUTFileHeader ret;
+  memset(&ret, 0, sizeof(ret));
+  memcpy(ret.magic, LUT_MAGIC, sizeof(ret.magic));
+  ret.version = LUT_VERSION;
+  ret.byteOrder = LUT_BYTE_ORDER;
+  ret.headerBytes = sizeof(LUTFileHeader);
+  ret.sampleRate = SAMPLES_PER_SECOND;
+  for(int i=0; i<4; i++){
+    for(int j=0; j<3; j++){
+      ret.micLocations[i][j] = MIC_LOCATIONS[i][j];
     }
+  }
+  ret.keyPrec = LUT_KEY_PREC;
+  ret.minOffset = MIN_OFFSET;
+  ret.maxOffset = MAX_OFFSET;
+  ret.fillTicks = LUT_FILL_TICKS;
+  ret.cellsPerAxis = LUT_CELLS_PER_AXIS;
+  ret.fillCellsPerAxis = LUT_FILL_CELLS_PER_AXIS;
+  return ret;
+}
 
-    std::vector<std::vector<float>>& entry
-      = found_points.at(offsets);
-    
-    entry.push_back(pt);
+/*! Continue a 64 bit FNV-1a hash over more bytes
+ *
+ * \param hash the hash so far. Start with 14695981039346656037.
+ * \param data bytes to add
+ * \param n number of bytes
+ * \return the updated hash
+ */
+uint64_t fnv1a(uint64_t hash, const void* data, size_t n){
+  const unsigned char* bytes = (const unsigned char*)data;
+  for(size_t i=0; i<n; i++){
+    hash = (hash ^ bytes[i])*1099511628211ull;
   }
+  return hash;
+}
 
-  /* Now, build the LUT using the found_points */
-  for(auto it=found_points.begin(); it!=found_points.end(); ++it){
-    std::vector<std::vector<float>> &bucket = it->second;
+/*! Starting value for fnv1a */
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
 
-    if(bucket.size() > 0){
-      float x=0.0f, y=0.0f, z=0.0f;
-      
-      for(int i=0; i<bucket.size(); i++){
-	std::vector<float> pt(bucket[i].begin(), bucket[i].begin()+3);
+int LocationLUT::cellIndex(const Vec3& offsets, int pad){
+  const int cells = LUT_CELLS_PER_AXIS + 2*pad;
+  int index = 0;
+  for(int i=0; i<3; i++){
+    float tick = keyTicks(offsets[i]) - LUT_KEY_PREC*MIN_OFFSET + pad;
+    //Written so that NaN fails too
+    if(!(tick >= 0.0f && tick < cells)){
+      return -1;
+    }
+    index = index*cells + (int)tick;
+  }
+  return index;
+}
 
-	float mag = dist(center, pt);
+void LocationLUT::buildLUT(){
+  //A sphere with 64k points on it, each point should be spaced
+  // about one degree apart. Finer keys, or a higher sample rate, split the
+  // same surface into more cells, so they get more points, to keep about
+  // as many per cell.
+  float keysPer16k = LUT_KEY_PREC*SAMPLES_PER_SECOND/16000.0f;
+  std::vector<Vec3> pts = genPoints((int)(256*256*keysPer16k*keysPer16k));
 
-	x += pt[0]/mag;
-	y += pt[1]/mag;
-	z += pt[2]/mag;
-      }
+  //Which cell each point lands in (or -1 to skip it), and the unit vector
+  // pointing at it
+  std::vector<int> cells(pts.size());
+  std::vector<Vec3> dirs(pts.size());
+
+  //Finding the offsets is nearly all of the work, and each point is
+  // independent, so split the points into one contiguous slice per core.
+  // Every thread writes only its own slice, so nothing needs a lock.
+  auto classify = [&pts, &cells, &dirs](size_t begin, size_t end){
+    static const std::vector<float> center = {0.0f, 0.0f, 0.0f};
+    float scale = 1.5;
+    
+    for(size_t i=begin; i<end; i++){
+      std::vector<float> pt
+	= {scale*pts[i][0], scale*pts[i][1], scale*pts[i][2]};
+      cells[i] = -1;
+      
+      //Don't worry about noises right next to the person
+      if(dist(center, pt) < 0.05) continue;
       
-      x /= bucket.size();
-      y /= bucket.size();
-      z /= bucket.size();
-
-      std::vector<float> newent = {
-	(float)x, (float)y, (float)z, (float)bucket.size()
-      };
-      lut.insert(std::make_pair(it->first, newent));
+      std::vector<float> offsets = offsetsForLocation(pt);
+      cells[i] = cellIndex({offsets[0], offsets[1], offsets[2]});
+
+      float mag = dist(center, pt);
+      dirs[i] = {pt[0]/mag, pt[1]/mag, pt[2]/mag};
     }
+  };
+
+  unsigned int numThreads = std::max(1u, std::thread::hardware_concurrency());
+  size_t slice = (pts.size() + numThreads - 1)/numThreads;
+  std::vector<std::thread> workers;
+  for(unsigned int t=1; t<numThreads; t++){
+    size_t begin = std::min(pts.size(), t*slice);
+    size_t end = std::min(pts.size(), begin + slice);
+    workers.emplace_back(classify, begin, end);
+  }
+  classify(0, std::min(pts.size(), slice));
+  for(std::thread& w : workers){
+    w.join();
   }
-}
 
-void LocationLUT::loadLUT(){
-  std::ifstream infile(FNAME);
-  if(infile.is_open()){
-    //std::cout << "loading LUT" << std::endl;
-    float floats[7];
-    char eatcomma;
-    int count;
-    std::string trash;
+  //Running sums of the unit vectors that land in each cell, kept in the
+  // table itself. This part stays serial and in point order: float
+  // addition isn't associative, so merging per-thread sums would change
+  // the averages slightly from one core count to the next.
+  lut.assign(LUT_CELLS_PER_AXIS*LUT_CELLS_PER_AXIS*LUT_CELLS_PER_AXIS,
+	     LUTEntry{0.0f, 0.0f, 0.0f, 0.0f});
+  for(size_t i=0; i<pts.size(); i++){
+    if(cells[i] < 0) continue;
     
-    infile >> count;
+    LUTEntry& entry = lut[cells[i]];
+    entry[0] += dirs[i][0];
+    entry[1] += dirs[i][1];
+    entry[2] += dirs[i][2];
+    entry[3] += 1.0f;
+  }
 
-    //Eat the heading line
-    for(int i=0; i<7; i++){
-      infile >> trash;
+  /* Now, turn the sums into averages */
+  populated = 0;
+  for(LUTEntry& entry : lut){
+    if(entry[3] > 0.0f){
+      entry[0] /= entry[3];
+      entry[1] /= entry[3];
+      entry[2] /= entry[3];
+      populated++;
+    } else {
+      entry = EMPTY_ENTRY;
     }
-    
-    for(int i=0; i<count; i++){
-      infile >> floats[0] >> eatcomma
-	     >> floats[1] >> eatcomma
-	     >> floats[2] >> eatcomma
-	     >> floats[3] >> eatcomma
-	     >> floats[4] >> eatcomma
-	     >> floats[5] >> eatcomma
-	     >> floats[6];
-
-      std::vector<float> key = {
-	floats[0], floats[1], floats[2]
-      };
-      std::vector<float> ent = {
-	floats[3], floats[4],floats[5], floats[6]
-      };
-      lut.insert(std::make_pair(key, ent));
+  }
+}
+
+#ifdef EMBEDDED_LUT
+/*! The cache file contents, generated by lutgen when sla was built. See
+ *  EMBED_LUT in the Makefile. */
+extern const unsigned char EMBEDDED_LUT_DATA[];
+/*! Length of EMBEDDED_LUT_DATA */
+extern const size_t EMBEDDED_LUT_BYTES;
+#endif
+
+void LocationLUT::loadLUT(){
+  //Keys are the delays of channels 1, 2 and 3 against channel 0, which
+  // only pin down a direction for 4 microphones
+  if(MIC_LOCATIONS.size() != 4){
+    throw std::string("LocationLUT needs exactly 4 microphones");
+  }
+#ifdef EMBEDDED_LUT
+  //Made by the same build from the same constants, so the checksum is
+  // skipped. That way only the pages that get used are ever read.
+  if(useLUTData(EMBEDDED_LUT_DATA, EMBEDDED_LUT_BYTES, false)){
+    return;
+  }
+  //lutgen always builds for the built in microphones, so a --geometry
+  // file can't be fixed by rebuilding
+  const LUTFileHeader& embedded = *(const LUTFileHeader*)EMBEDDED_LUT_DATA;
+  LUTFileHeader expected = currentHeader();
+  if(EMBEDDED_LUT_BYTES >= sizeof(LUTFileHeader)
+     && memcmp(embedded.micLocations, expected.micLocations,
+	       sizeof(expected.micLocations)) != 0){
+    throw std::string("the embedded LUT only covers the built in"
+		      " microphone geometry, build without EMBED_LUT=1 to"
+		      " use --geometry");
+  }
+  throw std::string("embedded LUT does not match this build,"
+		    " run make clean");
+#endif
+  
+  if(mapLUT()){
+    //std::cout << "lut mapped" << std::endl;
+    return;
+  }
+
+  //A lut.csv left by older versions is not read: it says nothing about
+  // the geometry, sample rate or key precision it was made for, and would
+  // be saved into lut.bin as if it matched this build
+  buildLUT();
+  //std::cout << "lut size, built: " << populated << std::endl;    
+  packLUT();
+  fillLUT();
+  usePacked();
+  saveLUT();
+}
+
+void LocationLUT::usePacked(){
+  entries = packed.data();
+  entryCells = packedCells.data();
+  closest = nearest.data();
+}
+
+void LocationLUT::generateBinary(std::ostream& out){
+  LocationLUT lut{Unloaded()};
+  lut.buildLUT();
+  lut.packLUT();
+  lut.fillLUT();
+  lut.usePacked();
+  lut.writeBinary(out);
+}
+
+bool LocationLUT::mapLUT(){
+  int fd = open(FNAME, O_RDONLY);
+  if(fd < 0){
+    return false;
+  }
+  struct stat st;
+  size_t bytes = 0;
+  void* data = MAP_FAILED;
+  if(fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(LUTFileHeader)){
+    bytes = st.st_size;
+    data = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  //The mapping stays valid after the file is closed
+  close(fd);
+  if(data == MAP_FAILED){
+    return false;
+  }
+
+  if(!useLUTData(data, bytes, true)){
+    //Stale or damaged. loadLUT will build a new one and replace it.
+    munmap(data, bytes);
+    return false;
+  }
+  mapped = data;
+  mappedBytes = bytes;
+  return true;
+}
+
+bool LocationLUT::useLUTData(const void* data, size_t bytes,
+			     bool checkData){
+  if(bytes < sizeof(LUTFileHeader)){
+    return false;
+  }
+  
+  const LUTFileHeader& header = *(const LUTFileHeader*)data;
+  LUTFileHeader expected = currentHeader();
+  if(memcmp(&header, &expected, offsetof(LUTFileHeader, populated)) != 0
+     || header.populated >= LUT_NO_ENTRY){
+    return false;
+  }
+  size_t entryBytes = lutEntryBytes(header.populated);
+  if(bytes != sizeof(LUTFileHeader) + entryBytes + LUT_FILL_BYTES){
+    return false;
+  }
+  const unsigned char* tables = (const unsigned char*)data
+    + sizeof(LUTFileHeader);
+  if(checkData && header.checksum != fnv1a(FNV_OFFSET_BASIS, tables,
+					   entryBytes + LUT_FILL_BYTES)){
+    return false;
+  }
+
+  populated = header.populated;
+  entries = (const PackedLUTEntry*)tables;
+  entryCells = (const uint32_t*)(tables
+				 + sizeof(PackedLUTEntry)*header.populated);
+  closest = (const uint16_t*)(tables + entryBytes);
+  return true;
+}
+
+void LocationLUT::packLUT(){
+  if(populated >= LUT_NO_ENTRY){
+    throw std::string("too many LUT entries for 16 bit indices,"
+		      " lower LUT_KEY_PREC");
+  }
+  
+  packed.clear();
+  packedCells.clear();
+  packed.reserve(populated);
+  packedCells.reserve(populated);
+  for(size_t i=0; i<lut.size(); i++){
+    const LUTEntry& entry = lut[i];
+    if(entry[3] <= 0.0f) continue;
+
+    PackedLUTEntry p;
+    for(int j=0; j<3; j++){
+      p.dir[j] = (int16_t)lroundf(PACKED_DIR_SCALE
+				  *std::max(-1.0f, std::min(1.0f, entry[j])));
     }
+    p.count = (uint16_t)std::min(entry[3], 65535.0f);
+    packed.push_back(p);
+    packedCells.push_back(i);
   }
-  //std::cout << "lut size, loaded: " << lut.size() << std::endl;
-    
-  if(lut.size() == 0){
-    buildLUT();
-    saveLUT();
+  populated = packed.size();
+
+  //Only the packed form is needed from here on
+  std::vector<LUTEntry>().swap(lut);
+}
+
+void LocationLUT::fillLUT(){
+  constexpr int N = LUT_FILL_CELLS_PER_AXIS;
+  constexpr int PAD = LUT_FILL_TICKS;
+  nearest.assign(N*N*N, LUT_NO_ENTRY);
+  //Steps from each cell to its closest entry, only valid where nearest is
+  // set
+  std::vector<uint8_t> steps(N*N*N, 0);
+  
+  //Breadth first, one step (in any of the 26 directions) at a time. A
+  // cell d steps from its closest entries has a neighbour d-1 steps from
+  // each of them, so taking the smallest entry index over those
+  // neighbours gives exactly the closest, smallest key.
+  std::vector<int> frontier, next;
+  for(unsigned int e=0; e<packedCells.size(); e++){
+    int i = packedCells[e]/(LUT_CELLS_PER_AXIS*LUT_CELLS_PER_AXIS);
+    int j = (packedCells[e]/LUT_CELLS_PER_AXIS) % LUT_CELLS_PER_AXIS;
+    int k = packedCells[e] % LUT_CELLS_PER_AXIS;
+    int cell = ((i+PAD)*N + (j+PAD))*N + (k+PAD);
+    nearest[cell] = e;
+    frontier.push_back(cell);
+  }
+
+  for(int step=1; step <= LUT_FILL_TICKS && frontier.size() > 0; step++){
+    next.clear();
+    for(int cell : frontier){
+      int x = cell/(N*N), y = (cell/N)%N, z = cell%N;
+      for(int dx=-1; dx<=1; dx++){
+	if(x+dx < 0 || x+dx >= N) continue;
+	for(int dy=-1; dy<=1; dy++){
+	  if(y+dy < 0 || y+dy >= N) continue;
+	  for(int dz=-1; dz<=1; dz++){
+	    if(z+dz < 0 || z+dz >= N) continue;
+	    int n = ((x+dx)*N + (y+dy))*N + (z+dz);
+	    if(nearest[n] == LUT_NO_ENTRY){
+	      nearest[n] = nearest[cell];
+	      steps[n] = step;
+	      next.push_back(n);
+	    } else if(steps[n] == step && nearest[cell] < nearest[n]){
+	      nearest[n] = nearest[cell];
+	    }
+	  }
+	}
+      }
+    }
+    frontier.swap(next);
   }
-  //std::cout << "lut size, built: " << lut.size() << std::endl;    
 }
 
-void LocationLUT::saveLUT(){
-  static std::vector<float> center = {0.0f, 0.0f, 0.0f};
+void LocationLUT::writeBinary(std::ostream& out){
+  LUTFileHeader header = currentHeader();
+  header.populated = populated;
+  header.checksum = fnv1a(FNV_OFFSET_BASIS, entries,
+			  sizeof(PackedLUTEntry)*populated);
+  header.checksum = fnv1a(header.checksum, entryCells,
+			  sizeof(uint32_t)*populated);
+  header.checksum = fnv1a(header.checksum, closest, LUT_FILL_BYTES);
+
+  out.write((const char*)&header, sizeof(header));
+  out.write((const char*)entries, sizeof(PackedLUTEntry)*populated);
+  out.write((const char*)entryCells, sizeof(uint32_t)*populated);
+  out.write((const char*)closest, LUT_FILL_BYTES);
+}
 
-  std::ofstream outfile(FNAME);
+void LocationLUT::saveLUT(){
+  //Written beside the real file and renamed over it, so a crash part way
+  // through never leaves a half written cache behind
+  std::string tmpName = std::string(FNAME) + ".tmp";
+  std::ofstream outfile(tmpName, std::ios::binary);
   //std::cout << "saving LUT" << std::endl;
+  writeBinary(outfile);
+  outfile.close();
+
+  if(outfile){
+    std::rename(tmpName.c_str(), FNAME);
+  } else {
+    //Not being able to cache isn't fatal, we just build again next time
+    std::remove(tmpName.c_str());
+  }
+}
 
-  outfile << lut.size() << std::endl;
+void LocationLUT::exportCSV(const std::string& fname){
+  std::ofstream outfile(fname);
+
+  outfile << populated << std::endl;
   outfile << "  d01,   d02,   d03,   dir_x,   dir_y,   dir_z, count"
 	  << std::endl;
-  
-  for(auto it=lut.begin(); it!=lut.end(); ++it){
-    outfile << std::fixed << std::setprecision(1)
-	    << std::setw(5) << (it->first)[0] << ", "
-	    << std::setw(5) << (it->first)[1] << ", "
-	    << std::setw(5) << (it->first)[2] << ", "
+
+  LUTEntry entry;
+  for(unsigned int e=0; e<populated; e++){
+    int i = entryCells[e]/(LUT_CELLS_PER_AXIS*LUT_CELLS_PER_AXIS);
+    int j = (entryCells[e]/LUT_CELLS_PER_AXIS) % LUT_CELLS_PER_AXIS;
+    int k = entryCells[e] % LUT_CELLS_PER_AXIS;
+    unpack(entries[e], entry);
+    
+    outfile << std::fixed << std::setprecision(2)
+	    << std::setw(5) << MIN_OFFSET + i/LUT_KEY_PREC << ", "
+	    << std::setw(5) << MIN_OFFSET + j/LUT_KEY_PREC << ", "
+	    << std::setw(5) << MIN_OFFSET + k/LUT_KEY_PREC << ", "
 	    << std::setprecision(4)
-	    << std::setw(7) << (it->second)[0] << ", "
-	    << std::setw(7) << (it->second)[1] << ", "
-	    << std::setw(7) << (it->second)[2] << ", "
-	    << std::setw(5) << (it->second)[3]
-      	    << std::endl;
+	    << std::setw(7) << entry[0] << ", "
+	    << std::setw(7) << entry[1] << ", "
+	    << std::setw(7) << entry[2] << ", "
+	    << std::setw(5) << entry[3]
+	    << std::endl;
   }
 }
 
-LocationLUT::LocationLUT(){
+LocationLUT::LocationLUT() : populated(0), entries(nullptr),
+			     entryCells(nullptr), closest(nullptr),
+			     mapped(nullptr), mappedBytes(0) {
   loadLUT();
 }
 
+LocationLUT::LocationLUT(Unloaded) : populated(0), entries(nullptr),
+				     entryCells(nullptr), closest(nullptr),
+				     mapped(nullptr), mappedBytes(0) {
+}
+
+LocationLUT::~LocationLUT(){
+  if(mapped != nullptr){
+    munmap(mapped, mappedBytes);
+  }
+}
+
 std::vector<float>
 LocationLUT::get(std::vector<float> offsets){
-  if(lut.count(offsets) > 0){
-    std::vector<float> &entry
-      = lut.at(offsets);
-    return entry;
+  Vec3 key = {offsets[0], offsets[1], offsets[2]};
+  LUTEntry entry;
+  get(key, entry);
+  return std::vector<float>(entry.begin(), entry.end());
+}
+
+void LocationLUT::get(const Vec3& offsets, LUTEntry& entry){
+  int index = cellIndex(offsets, LUT_FILL_TICKS);
+  if(index >= 0 && closest[index] != LUT_NO_ENTRY){
+    unpack(entries[closest[index]], entry);
   } else {
-    //TODO: Spiral out, keep looking
-    constexpr float TICK_SIZE = 1/LUT_KEY_PREC;
-    int num_ticks = 1;
-    while(num_ticks < 10){
-      for(int x=-num_ticks; x <= num_ticks; x++){
-	for(int y=-num_ticks; y <= num_ticks; y++){
-	  for(int z=-num_ticks; z <= num_ticks; z++){
-	    std::vector<float> trial_offsets = {
-	      offsets[0] + x*TICK_SIZE,
-	      offsets[1] + y*TICK_SIZE,
-	      offsets[2] + z*TICK_SIZE
-	    };
-	    if(lut.count(trial_offsets) > 0){
-	      return lut.at(trial_offsets);
-	    }
-	  }
-	}
-      }
-      num_ticks++;
-    }
-    std::vector<float> ret = {10.0f, 10.0f, 10.0f, -1.0f};
-    return ret;
+    entry = EMPTY_ENTRY;
   }
 }
+
+void LocationLUT::unpack(const PackedLUTEntry& packed, LUTEntry& entry){
+  entry[0] = packed.dir[0]/PACKED_DIR_SCALE;
+  entry[1] = packed.dir[1]/PACKED_DIR_SCALE;
+  entry[2] = packed.dir[2]/PACKED_DIR_SCALE;
+  entry[3] = packed.count;
+}
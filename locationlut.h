@@ -36,22 +36,68 @@
 
 #pragma once
 
-#include <unordered_map>
-#include <functional>
 #include <vector>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <ostream>
 
 #include "constants.h"
+#include "geometry.h"
+#include "utils.h"
 
 /*! xyz coordinats used in the keys of the lookup table will be an integer
-    multiple of this value */
+    multiple of 1/LUT_KEY_PREC. Values of 2 to 4 make use of the fractional
+    delays from --subsample. */
 constexpr float LUT_KEY_PREC = 1.0f;
-/*! The maximum delay that might be used in a key in the data structure */
+/*! The maximum delay that might be used in a key in the data structure.
+ *  Fixed at compile time for the built in array, so main refuses the LUT
+ *  for a --geometry whose delays can be longer. */
 constexpr int MAX_OFFSET = (int)(SENSOR_SPACING_SAMPLES*1.25);
 /*! The minimum delay that might be used in a key in the data structure */
 constexpr int MIN_OFFSET = -MAX_OFFSET;
+/*! Number of distinct key values along each axis of the table */
+constexpr int LUT_CELLS_PER_AXIS =
+  (int)(LUT_KEY_PREC*(MAX_OFFSET - MIN_OFFSET)) + 1;
+/*! A key with no entry of its own gets the closest entry no more than
+ *  this many steps of 1/LUT_KEY_PREC away on any axis. Anything further
+ *  away is a failed lookup. */
+constexpr int LUT_FILL_TICKS = 9;
+/*! Keys out to LUT_FILL_TICKS beyond the table on each side can still be
+ *  near an entry, so the fill covers a slightly bigger cube */
+constexpr int LUT_FILL_CELLS_PER_AXIS = LUT_CELLS_PER_AXIS + 2*LUT_FILL_TICKS;
+/*! Marks a key with no entry close enough. Also the limit on how many
+ *  keys can have entries. */
+constexpr uint16_t LUT_NO_ENTRY = 0xffff;
+
+/*! One entry of the lookup table: the x, y, z of a unit vector, and the
+ *  number of sample points that were averaged to make it. Empty cells
+ *  have a count of -1. */
+typedef std::array<float, 4> LUTEntry;
+
+/*! How LUTEntry is stored once the table is built: the direction in
+ *  signed 16 bit fixed point, where 32767 is 1.0, and the count */
+struct PackedLUTEntry {
+  int16_t dir[3];
+  uint16_t count;
+};
 
 /*! A class to build and manage a lookup table to convert an array of
  *  delays into a direction 
+ *
+ *  Keys are whole multiples of 1/LUT_KEY_PREC between MIN_OFFSET and
+ *  MAX_OFFSET on each axis, so a dense 3D array of 16 bit indices gives
+ *  the entry for each key, and a lookup is just an index computation.
+ *  Keys that have no entry of their own are given their closest entry
+ *  once, when the table is built, so misses cost the same as hits. Only
+ *  a thin shell of keys actually has entries, so the entries themselves
+ *  are kept in a short list, packed into 8 bytes each.
+ *
+ *  All of this is cached in lut.bin, which is mapped into memory and
+ *  used as is, so startup does no parsing and no building unless the
+ *  file is missing or was made for a different geometry. Building with
+ *  EMBED_LUT=1 links the same data into the program instead.
+ *
  *  \note Singleton, with lazy initialization. (Meyers style singleton) 
  */
 class LocationLUT {
@@ -65,13 +111,45 @@ class LocationLUT {
  private:
   //!ctor and dtor are private to encourage correct usage of singleton
   LocationLUT();
+  ~LocationLUT();
+  //! Tag for the constructor that leaves the table empty
+  struct Unloaded {};
+  //! Empty table, for generateBinary to build into
+  explicit LocationLUT(Unloaded);
 
   //! Build the lookup table
   void buildLUT();
-  //! Load the lookup table from disk, building it if necessary
+  /*! Load the lookup table from disk, building it if necessary. Throws a
+   *  std::string unless there are exactly 4 microphones. */
   void loadLUT();
-  //! Save the lookup table to disk
+  /*! Map the binary cache file, if there is one and it matches the
+   *  current geometry
+   *
+   * \return true if entries and closest now point into the file
+   */
+  bool mapLUT();
+  /*! Point entries and closest at tables in the cache file format
+   *
+   * \param data start of the file contents
+   * \param bytes length of the file contents
+   * \param checkData verify the checksum, as well as the header
+   * \return true if the header matches the current geometry and the
+   *         tables are now in use
+   */
+  bool useLUTData(const void* data, size_t bytes, bool checkData);
+  //! Save the lookup table to the binary cache file
   void saveLUT();
+  //! Move the populated cells of lut into packed and packedCells
+  void packLUT();
+  //! Work out the closest entry to every key, filling in nearest
+  void fillLUT();
+  //! Point entries, entryCells and closest at the tables just built
+  void usePacked();
+  /*! Write the table in the binary cache file format
+   *
+   * \param out stream to write to, opened in binary mode
+   */
+  void writeBinary(std::ostream& out);
 
  public:
   /*! Copy ctor deleted so that we don't accidentally make a copy */
@@ -87,26 +165,75 @@ class LocationLUT {
    * \return a unit vector that represents the direction of the sound
    */
   std::vector<float> get(std::vector<float> offsets);
+
+  /*! Allocation free version of get
+   *
+   * \param offsets offsets[i] contains the delay between channel 0 and
+   *        channel i+1.
+   * \param entry receives the unit vector in the first three items, and the
+   *        number of sample points that mapped to this entry in the last.
+   *        If nothing close enough is found, gets {10, 10, 10, -1}.
+   */
+  void get(const Vec3& offsets, LUTEntry& entry);
+
+  /*! Write the populated entries out as text, one per line, for people
+   *  and plotting tools to read
+   *
+   * \param fname file to write
+   */
+  void exportCSV(const std::string& fname);
+
+  /*! Build the table from scratch and write it in the binary cache file
+   *  format, without reading or writing any files. lutgen uses this to
+   *  embed the table in the program, so it always covers the built in
+   *  microphone geometry.
+   *
+   * \param out stream to write to, opened in binary mode
+   */
+  static void generateBinary(std::ostream& out);
   
  private:
-  /*! The key type for our lookup table */
-  typedef std::vector<float> key_t;
+  /*! Position of a key in the table
+   *
+   * \param offsets the key. Rounded to the nearest whole multiple of
+   *        1/LUT_KEY_PREC.
+   * \param pad how many cells the table extends beyond
+   *        [MIN_OFFSET, MAX_OFFSET] on each side. 0 for lut,
+   *        LUT_FILL_TICKS for nearest.
+   * \return index into the table, or -1 if the key is out of range
+   */
+  static int cellIndex(const Vec3& offsets, int pad = 0);
 
-  /*! hash function for use in lookup table */
-  struct key_hash : public std::unary_function<key_t, std::size_t> {
-    std::size_t operator()(const key_t& k) const {
-      std::hash<long> long_hash; //TODO: Performance?
+  /*! Expand a stored entry back into the form get returns */
+  static void unpack(const PackedLUTEntry& packed, LUTEntry& entry);
   
-      long size = LUT_KEY_PREC*(MAX_OFFSET - MIN_OFFSET);
-      long val = LUT_KEY_PREC*k[0] - LUT_KEY_PREC*MIN_OFFSET;
-      val = val*size + (LUT_KEY_PREC*k[1] - LUT_KEY_PREC*MIN_OFFSET);
-      val = val*size + (LUT_KEY_PREC*k[2] - LUT_KEY_PREC*MIN_OFFSET);
-      return long_hash(val);
-    }
-  };
-
-  /*! The actual lookup table */
-  std::unordered_map<std::vector<float>,
-    std::vector<float>,
-    key_hash> lut;
+  /*! The full table, only used while building. Cell (i, j, k) holds the
+   *  key (MIN_OFFSET + i/LUT_KEY_PREC, MIN_OFFSET + j/LUT_KEY_PREC,
+   *  MIN_OFFSET + k/LUT_KEY_PREC), at index (i*N + j)*N + k with
+   *  N = LUT_CELLS_PER_AXIS. */
+  std::vector<LUTEntry> lut;
+  /*! The cells of lut that are not empty, in order */
+  std::vector<PackedLUTEntry> packed;
+  /*! packedCells[e] is the index in lut that packed[e] came from */
+  std::vector<uint32_t> packedCells;
+  /*! For each key in the padded cube of side LUT_FILL_CELLS_PER_AXIS, the
+   *  index in packed of the closest entry, or LUT_NO_ENTRY if there is
+   *  none within LUT_FILL_TICKS. Closest is by the largest difference on
+   *  any one axis, with ties going to the smallest key (x first, then y,
+   *  then z). */
+  std::vector<uint16_t> nearest;
+  /*! Number of cells that are not empty */
+  unsigned int populated;
+
+  /*! What get uses in place of packed: either packed itself or the list in
+   *  the mapped cache file */
+  const PackedLUTEntry* entries;
+  /*! What exportCSV uses in place of packedCells, just like entries */
+  const uint32_t* entryCells;
+  /*! What get uses in place of nearest, just like entries */
+  const uint16_t* closest;
+  /*! Start of the mapped cache file, or nullptr if it isn't mapped */
+  void* mapped;
+  /*! Length of the mapping */
+  size_t mappedBytes;
 };
@@ -0,0 +1,83 @@
+/** \file lutgen.cpp
+ * Build time generator for the location lookup table.
+ *
+ * Builds the LocationLUT and writes it out as a C++ source file holding
+ * one big constant array, in the same format as the lut.bin cache. When
+ * sla is built with EMBED_LUT=1, that file is compiled and linked in, so
+ * the table lives in the program's read only data and startup does no
+ * file I/O and no building.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cstdio>
+
+#include "locationlut.h"
+
+/*! Usage: lutgen <output.cpp> */
+int main(int argc, char* argv[]) {
+  if(argc != 2){
+    std::cerr << "usage: " << argv[0] << " <output.cpp>" << std::endl;
+    return 1;
+  }
+
+  std::ostringstream bin(std::ios::binary);
+  LocationLUT::generateBinary(bin);
+  const std::string data = bin.str();
+
+  std::ofstream out(argv[1]);
+  out << "// Generated by lutgen, do not edit" << std::endl
+      << "#include <cstddef>" << std::endl
+      << std::endl
+      << "extern const unsigned char EMBEDDED_LUT_DATA[];" << std::endl
+      << "extern const size_t EMBEDDED_LUT_BYTES;" << std::endl
+      << std::endl
+      << "alignas(16) const unsigned char EMBEDDED_LUT_DATA[] = {"
+      << std::endl;
+  
+  char hex[8];
+  for(size_t i=0; i<data.size(); i++){
+    snprintf(hex, sizeof(hex), "0x%02x,", (unsigned char)data[i]);
+    out << hex;
+    if(i % 16 == 15){
+      out << std::endl;
+    }
+  }
+  out << "};" << std::endl
+      << "const size_t EMBEDDED_LUT_BYTES = " << data.size() << ";"
+      << std::endl;
+  out.close();
+
+  if(!out){
+    std::cerr << "could not write " << argv[1] << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -29,24 +29,97 @@
 #include <iostream>
 #include <iomanip>
 #include <cmath>
+#include <algorithm>
 
 #include "microphone.h"
 #include "locationlut.h"
 #include "server.h"
 #include "soundProcessing.h"
+#include "soundFrame.h"
+#include "gccPhat.h"
+#include "tdoa.h"
+#include "geometry.h"
+#include "decimator.h"
+#include "noiseGate.h"
+#include "slidingWindow.h"
+#include "coarseSearch.h"
+#include "srp.h"
+#include "sourceAssociation.h"
+#include "bandLocalizer.h"
 #include "constants.h"
 #include "tracker.h"
 #include "updateServer.h"
 #include "utils.h"
+#include "settings.h"
+#include "allocCheck.h"
+
+/*! Frames to process before the allocation check starts. Everything that
+ *  needs memory should have grabbed it by then. */
+constexpr long WARMUP_FRAMES = 100;
+
+/*! Directions the least squares solver is less sure of than this are
+ *  dropped, like a failed LUT lookup. 0.25 means the delays are off by 3
+ *  samples, root mean square, from any single direction. */
+constexpr float MIN_SOLVER_CONFIDENCE = 0.25f;
 
 /*! Main controller method for the whole project */
-int main() {
+int main(int argc, char* argv[]) {
+  Settings settings = parseSettings(argc, argv);
+  if(!settings.geometryFile.empty()){
+    loadMicLocations(settings.geometryFile);
+  }
+  settings.channels = MIC_LOCATIONS.size();
+  if(settings.solver == DirectionSolver::LUT && settings.channels != 4){
+    throw std::string("the LUT solver only works with 4 microphones, "
+		      "use --solver=ls");
+  }
+  //The LUT's keys only reach MAX_OFFSET samples, so on a wider array
+  // directions with longer delays would never get an entry
+  if(settings.solver == DirectionSolver::LUT
+     && std::ceil(maxMicDelay()) > MAX_OFFSET){
+    throw std::string("the LUT solver only covers delays up to ")
+      + std::to_string(MAX_OFFSET) + " samples, and this array needs "
+      + std::to_string((int)std::ceil(maxMicDelay())) + ", use --solver=ls";
+  }
+  if(settings.solver == DirectionSolver::SRP && settings.sources > 1){
+    throw std::string("--sources needs --solver=lut or --solver=ls");
+  }
+  if(settings.bands > 0 && (settings.solver == DirectionSolver::SRP
+			    || settings.sources > 1
+			    || settings.coarseCandidates > 0)){
+    throw std::string("--bands finds one direction per band with "
+		      "--solver=lut or --solver=ls, and can't be combined "
+		      "with --sources or --coarse");
+  }
+  //Both take the whole curve of every pair, not just its peak
+  bool wholeCurves = settings.solver == DirectionSolver::SRP
+    || settings.sources > 1;
+  if(wholeCurves && settings.coarseCandidates > 0){
+    throw std::string("--coarse only finds peaks, --solver=srp and "
+		      "--sources need whole correlation curves");
+  }
+  if(settings.engine != DelayEngine::TIME_DOMAIN
+     && settings.coarseCandidates > 0){
+    throw std::string("--coarse only refines time domain correlations, "
+		      "it can't be combined with --engine=gcc or gcc-phat");
+  }
+  
   //std::cout << "updating IP Discovery Server" << std::endl;
   updateIPDiscoveryServer();
   
-  //Build the LUT before opening the mic
+  //Build the LUT before opening the mic. The least squares solver doesn't
+  // use it, so then it is never built or loaded, unless it is being
+  // exported.
   //std::cout << "building LUT" << std::endl;
-  LocationLUT& lut = LocationLUT::getInstance();
+  LocationLUT* lut = nullptr;
+  if(settings.solver == DirectionSolver::LUT ||
+     !settings.exportLUT.empty()){
+    lut = &LocationLUT::getInstance();
+  }
+  if(!settings.exportLUT.empty()){
+    lut->exportCSV(settings.exportLUT);
+  }
+  TdoaSolver solver;
 
   //std::cout << "creating Tracker" << std::endl;
   Tracker& t = Tracker::getInstance();
@@ -55,66 +128,292 @@ int main() {
   Server& s = Server::getInstance(t);
 
   //std::cout << "creating Microphone" << std::endl;
-  Microphone& m = Microphone::getInstance();
+  Microphone& m = Microphone::getInstance(settings);
   
   long frameNumber = 0;
 
+  //Brings the capture rate down to SAMPLES_PER_SECOND, if they differ
+  Decimator decimator(m.channels, m.rate/SAMPLES_PER_SECOND);
+  unsigned int frames = m.frames/decimator.factor;
+  //Most recent period, at SAMPLES_PER_SECOND, one channel after the other
+  std::vector<int16_t> buffer(frames*m.channels, 0);
+  //The period as the capture thread handed it over. Only separate from
+  // buffer when decimating.
+  std::vector<int16_t> captured;
+  if(decimator.factor > 1){
+    captured.resize(m.frames*m.channels, 0);
+  }
+  std::vector<int16_t>& raw = decimator.factor > 1 ? captured : buffer;
+  //Longest delay to search for. Never less than the original 2 sensor
+  // spacings, but a wider array needs more.
+  int lagRange = std::max((int)(2*SENSOR_SPACING_SAMPLES),
+			  (int)std::ceil(maxMicDelay()));
+  //Windows to analyse, by default one per period
+  unsigned int windowFrames = settings.window ? settings.window : frames;
+  //Lags near the window length overlap by a handful of samples or none,
+  // and the correlations normalized by that overlap are garbage
+  unsigned int minWindow = 2*(lagRange + 2);
+  if(windowFrames < minWindow){
+    throw std::string("--window must be at least ")
+      + std::to_string(minWindow)
+      + " samples, twice the longest delay searched for";
+  }
+  SlidingWindow window(windowFrames,
+		       settings.hop ? settings.hop : windowFrames,
+		       m.channels, lagRange + 2, frames);
+  //The current window, split into channels, for the stages that can't
+  // work straight from the history
+  SoundFrame frame(windowFrames, m.channels);
+
+  //Output of the time domain delay engine
+  PairCorrelations pairs(lagRange + 2, m.channels);
+  //Only used with --coarse
+  CoarseSearch coarse(lagRange);
+  //Only used if one of the FFT based delay engines is selected
+  GccPhat gcc(windowFrames, m.channels, lagRange + 2,
+	      settings.engine == DelayEngine::GCC_PHAT);
+  //Curves of every pair, all normalized so a perfect match is 1.0. Only
+  // filled in with --solver=srp or --sources.
+  unsigned int curveLen = 2*(lagRange + 2) + 1;
+  std::vector<float> curves(wholeCurves ? numPairs(m.channels)*curveLen : 0);
+  //Only used with --solver=srp
+  bool srpSolver = settings.solver == DirectionSolver::SRP;
+  SrpLocator srp(srpSolver ? SRP_LEVELS : 0, lagRange + 2);
+  //Only used with --sources
+  SourceAssociator associator(std::max(1u, settings.sources), lagRange + 2);
+  //Only used with --bands. The Pi has 4 cores; the capture thread barely
+  // uses its one.
+  BandLocalizer bandLoc(windowFrames, m.channels, lagRange + 2,
+			std::max(1u, settings.bands),
+			settings.bands > 0 ? std::thread::hardware_concurrency()
+			: 1);
+  //Directions found in the current window
+  std::vector<Vec3> found;
+  found.reserve(MAX_SOURCES);
+
+  //offsets[pairIndex(i, j, m.channels)] is t_i - t_j in samples: how much
+  // later the sound reached channel i than channel j
+  std::vector<float> offsets(numPairs(m.channels), 0.0f);
+  //Pairs other than those against channel 0 are only worked out if the
+  // solver will use them
+  bool allPairs = settings.solver == DirectionSolver::LEAST_SQUARES;
+  std::array<float, 4> entry;
+  Vec3 last_pt = {10.0f, 10.0f, 10.0f};
+  //Loudness and delays of the latest window, for the server, in the same
+  // order as offsets
+  float loudness = 0.0f;
+  std::vector<float> shown(numPairs(m.channels), 0.0f);
+  //Only used with --gate. Updated once per window.
+  NoiseGate gate((float)(settings.hop ? settings.hop : windowFrames)
+		 /SAMPLES_PER_SECOND);
+  //LUT assumes that stream 0 is the primary stream, so the offets
+  // user are 1, 2, and 3 (not 0)
+  auto lutKey = [&m](const std::vector<float>& delays){
+    return Vec3{
+      delays[pairIndex(0, 1, m.channels)],
+      delays[pairIndex(0, 2, m.channels)],
+      delays[pairIndex(0, 3, m.channels)]
+    };
+  };
+  //Direction of one set of delays, with the LUT or least squares solver.
+  // {10, 10, 10} if it fails.
+  auto direction = [&](const std::vector<float>& delays, const Vec3& key){
+    Vec3 pt = {10.0f, 10.0f, 10.0f};
+    if(settings.solver == DirectionSolver::LUT){
+      //Now do a LUT lookup
+      lut->get(key, entry);
+      pt = {entry[0], entry[1], entry[2]};
+    } else if(solver.solve(delays, pt) < MIN_SOLVER_CONFIDENCE){
+      pt = {10.0f, 10.0f, 10.0f};
+    }
+    return pt;
+  };
+  //Only changes in builds with -DCHECK_ALLOCATIONS
+  unsigned long warmAllocations = 0;
+  
   //std::cout << "main loop starting" << std::endl;
   //Loop forever. Right now, must kill via ctrl-c
   while(s.isRunning()){
-    int retVal;
-
     //First, read data
-    //Should block if data not yet ready
-    retVal = snd_pcm_readi(m.handle, (char*)m.buffer.data(), m.frames);
-    if(retVal < 0){
-      throw std::string("microphone read failed: ") + snd_strerror(retVal);
+    //Blocks until the capture thread has a period ready. The timeout is
+    // just so we notice when the server has been told to exit.
+    if(!m.read(raw, 1000)){
+      continue;
+    }
+    if(decimator.factor > 1){
+      decimator.process(raw, buffer);
     }
 
-    //Next, calculate mean and stdev for rescaling and centering signals
-    std::vector<std::pair<float, float> > l = meansAndStdDevs(m.buffer);
-    //Find the loudness of the loudest channel
-    float loudness = l[0].second;
-    int loudest = 0;
-    for(int i=1; i<l.size(); i++){
-      if(l[i].second > loudness){
-	loudness = l[i].second;
-	loudest = i;
+    //Add the period to the sample history. Every window that is now
+    // complete gives one direction; by default that is one per period.
+    window.push(buffer);
+    //True if frame holds the latest window
+    bool copied = false;
+    while(window.next()){
+      copied = false;
+      //Mean and stdev of each channel, kept up to date as the window
+      // slides
+      const std::vector<std::pair<float, float> >& l = window.stats();
+      //Find the loudness of the loudest channel
+      loudness = l[0].second;
+      for(int i=1; i<l.size(); i++){
+	if(l[i].second > loudness){
+	  loudness = l[i].second;
+	}
       }
-    }
 
-    //recenter(m.buffer, l);
+      //Frames with nothing above the noise floor skip straight to the
+      // server, as a failed lookup with no delays
+      std::fill(shown.begin(), shown.end(), 0.0f);
+      Vec3 cur_pt = {10.0f, 10.0f, 10.0f};
+      found.clear();
+      if(!settings.gate || gate.update(l, loudness)){
+	//The exhaustive time domain search works straight from the history.
+	// Anything else gets the window split into channels, recentered if
+	// that is turned on.
+	bool fromHistory = settings.engine == DelayEngine::TIME_DOMAIN
+	  && !settings.removeDC && settings.coarseCandidates == 0
+	  && settings.bands == 0;
+	if(!fromHistory){
+	  window.copyTo(frame, settings.removeDC);
+	  copied = true;
+	}
+	
+	if(settings.bands > 0){
+	  bandLoc.process(frame, settings.subsample);
+	} else if(settings.coarseCandidates > 0){
+	  coarse.setFrame(frame);
+	  for(unsigned int i=0; i < m.channels; i++){
+	    for(unsigned int j=i+1; j < m.channels; j++){
+	      if(i == 0 || allPairs){
+		offsets[pairIndex(i, j, m.channels)] =
+		  -coarse.delay(i, j, lagRange, settings.coarseCandidates,
+				settings.subsample).first;
+	      }
+	    }
+	  }
+	} else if(settings.engine == DelayEngine::TIME_DOMAIN){
+	  //All pairs in one pass, or just the hop that changed
+	  if(fromHistory){
+	    window.correlate(lagRange + 2, pairs);
+	  } else {
+	    correlateAllPairs(frame, lagRange + 2, pairs);
+	  }
+	  if(wholeCurves){
+	    normalizedCurves(pairs, curves.data());
+	  } else {
+	    for(unsigned int p=0; p < offsets.size(); p++){
+	      offsets[p] = -pairs.delay(p, settings.subsample).first;
+	    }
+	  }
+	} else {
+	  gcc.setFrame(frame);
+	  for(unsigned int i=0; i < m.channels; i++){
+	    for(unsigned int j=i+1; j < m.channels; j++){
+	      if(wholeCurves){
+		gcc.curve(i, j, lagRange + 2,
+			  curves.data() + pairIndex(i, j, m.channels)*curveLen);
+	      } else if(i == 0 || allPairs){
+		offsets[pairIndex(i, j, m.channels)] =
+		  -gcc.delay(i, j, lagRange, settings.subsample).first;
+	      }
+	    }
+	  }
+	}
+
+	if(srpSolver){
+	  //The delays are those of the direction picked
+	  if(srp.locate(curves.data(), cur_pt) < MIN_SRP_SCORE){
+	    cur_pt = {10.0f, 10.0f, 10.0f};
+	  }
+	  for(unsigned int p=0; p < offsets.size(); p++){
+	    offsets[p] = -srp.lag(p);
+	  }
+	  shown = offsets;
+	} else if(settings.bands > 0){
+	  //Every band that isn't just leakage from a louder one gets its own
+	  // direction. The server shows the loudest band's delays.
+	  unsigned int loudest = 0;
+	  for(unsigned int b=1; b < bandLoc.bands(); b++){
+	    if(bandLoc.level(b) > bandLoc.level(loudest)){
+	      loudest = b;
+	    }
+	  }
+	  for(unsigned int b=0; b < bandLoc.bands(); b++){
+	    if(bandLoc.level(b) < MIN_BAND_SHARE*bandLoc.level(loudest)){
+	      continue;
+	    }
+	    Vec3 key = lutKey(bandLoc.offsets(b));
+	    Vec3 pt = direction(bandLoc.offsets(b), key);
+	    if(b == loudest){
+	      shown = bandLoc.offsets(b);
+	      cur_pt = pt;
+	    }
+	    if(pt[0] < 2.0f){
+	      t.addPoint(pt, loudness, frameNumber, 1u << b);
+	    }
+	  }
+	} else if(settings.sources > 1){
+	  //Each sound gets its own delays, and its own direction. A set of
+	  // delays no direction fits is dropped.
+	  unsigned int n = associator.associate(curves.data(),
+						settings.subsample);
+	  for(unsigned int src=0; src < n; src++){
+	    Vec3 key = lutKey(associator.offsets(src));
+	    Vec3 pt = direction(associator.offsets(src), key);
+	    if(src == 0){
+	      shown = associator.offsets(src);
+	    }
+	    if(pt[0] < 2.0f){
+	      found.push_back(pt);
+	    }
+	  }
+	  if(!found.empty()){
+	    cur_pt = found[0];
+	  }
+	} else {
+	  shown = offsets;
+	  cur_pt = direction(offsets, lutKey(offsets));
+	}
+      }
+      if(frameNumber == 0){
+	last_pt = cur_pt;
+      }
     
-    std::pair<float, float> delays[NUM_CHANNELS];
-    for(int j=0; j < NUM_CHANNELS; j++){
-      delays[j] = delay(m.buffer, 0, j, 2*SENSOR_SPACING_SAMPLES);
+      float d = dist(cur_pt, last_pt);
+      //If lookup failed we get back 10.0f, so skip this data point. With
+      // --bands every band has been added already, with its own tag.
+      if(found.empty() && cur_pt[0] < 2.0f){
+	found.push_back(cur_pt);
+      }
+      if(settings.bands == 0){
+	t.addPoints(found, loudness, frameNumber);
+      }
+      last_pt = cur_pt;
     }
 
-    //LUT assumes that stream 0 is the primary stream, so the offets
-    // user are 1, 2, and 3 (not 0)
-    //Now do a LUT lookup
-    std::vector<float> loc = {
-      -delays[1].first,
-      -delays[2].first,
-      -delays[3].first
-    };
-
-    std::vector<float> entry = lut.get(loc);
-
-    std::vector<float> cur_pt(entry.begin(), entry.begin()+3);
-    static std::vector<float> last_pt = cur_pt;
-        
-    float d = dist(cur_pt, last_pt);
-    //If lookup failed we get back 10.0f, so skip this data point
-    if(cur_pt[0] < 2.0f){
-      t.addPoint(cur_pt, loudness, frameNumber);    
+    //Hands the latest window to the server, which gives back its old frame
+    // in exchange. The window only has to be copied out of the history if
+    // the delay engine didn't already need it in a frame.
+    if(window.ready()){
+      if(!copied){
+	window.copyTo(frame, settings.removeDC);
+      }
+      s.putBuffer(frame, loudness, shown);
     }
-
-    s.putBuffer(m.buffer, loudness, loc);
+    s.putCaptureStats(m.stats());
+    s.putGateStats(gate.stats());
     s.tickTo(frameNumber);
       
+    if(frameNumber == WARMUP_FRAMES){
+      warmAllocations = threadAllocations();
+    } else if(frameNumber > WARMUP_FRAMES &&
+	      threadAllocations() != warmAllocations){
+      throw std::string("main loop allocated after warm-up, frame ")
+	+ std::to_string(frameNumber);
+    }
+    
     frameNumber++;
-    last_pt = cur_pt;
   }
   return 0;
 }
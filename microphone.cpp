@@ -34,16 +34,25 @@
 #include "microphone.h"
 #include "constants.h"
 #include <string>
+#include <cerrno>
+#include <iostream>
 
 constexpr char DEVICE_ID[] = "hw:1,0";
 
-Microphone::Microphone() {
+/*! Number of periods the capture thread can get ahead of the processing
+ *  loop before it starts dropping them. */
+constexpr unsigned int CAPTURE_RING_PERIODS = 8;
+
+Microphone::Microphone(const Settings& settings) :
+  useMmap(settings.useMmap), capturing(false), captured(0), overruns(0), dropped(0), failed(false) {
   int rc;
   unsigned int val, val2;
   int dir;
 
-  channels = NUM_CHANNELS;
-  rate = SAMPLES_PER_SECOND;
+  channels = settings.channels;
+  rate = settings.captureRate;
+  //Capture periods must decimate to a whole number of frames
+  unsigned int factor = rate/SAMPLES_PER_SECOND;
   
   /* Open PCM device for playback. */
   rc = snd_pcm_open(&handle, DEVICE_ID,
@@ -62,8 +71,19 @@ Microphone::Microphone() {
   /* Set the desired hardware parameters. */
 
   /* Interleaved mode */
-  snd_pcm_hw_params_set_access(handle, params,
-			       SND_PCM_ACCESS_RW_INTERLEAVED);
+  if(useMmap){
+    rc = snd_pcm_hw_params_set_access(handle, params,
+				      SND_PCM_ACCESS_MMAP_INTERLEAVED);
+    if(rc < 0){
+      std::cerr << "mmap capture not supported, using readi: "
+		<< snd_strerror(rc) << '\n';
+      useMmap = false;
+    }
+  }
+  if(!useMmap){
+    snd_pcm_hw_params_set_access(handle, params,
+				 SND_PCM_ACCESS_RW_INTERLEAVED);
+  }
 
   /* Signed 16-bit little-endian format */
   snd_pcm_hw_params_set_format(handle, params,
@@ -73,8 +93,15 @@ Microphone::Microphone() {
 
   snd_pcm_hw_params_set_rate_near(handle,
 				  params, &rate, &dir);
+  //Every delay is measured in samples, so a nearby rate won't do
+  if(rate != settings.captureRate){
+    snd_pcm_close(handle);
+    throw std::string("microphone can't capture at ")
+      + std::to_string(settings.captureRate) + " Hz, nearest is "
+      + std::to_string(rate);
+  }
 
-  frames = (int)(0.5 + (double)rate/TARGET_FRAME_RATE);
+  frames = factor*(int)(0.5 + (double)SAMPLES_PER_SECOND/TARGET_FRAME_RATE);
   snd_pcm_hw_params_set_period_size_near(handle, params,
 					 &frames, &dir);
   /* Write the parameters to the driver */
@@ -87,10 +114,174 @@ Microphone::Microphone() {
   /*Get frame size after init */
   snd_pcm_hw_params_get_period_size(params,
 				    &frames, &dir);
+  if(frames % factor != 0){
+    snd_pcm_close(handle);
+    throw std::string("period of ") + std::to_string(frames)
+      + " frames can't be decimated by " + std::to_string(factor);
+  }
   int size = frames*channels;
-  buffer.resize(size, 0);
+  ring.reset(new FrameRing(CAPTURE_RING_PERIODS, size));
+  scratch.resize(size, 0);
+  if(!useMmap){
+    interleaved.resize(size, 0);
+  }
+
+  capturing = true;
+  captureThread = std::thread(&Microphone::captureLoop, this);
 }
 
 Microphone::~Microphone(){
+  capturing = false;
+  if(captureThread.joinable()){
+    captureThread.join();
+  }
   snd_pcm_close(handle);
 }
+
+bool Microphone::recover(int rc){
+  if(rc == -EPIPE){
+    overruns++;
+    rc = snd_pcm_prepare(handle);
+  } else {
+    rc = snd_pcm_recover(handle, rc, 1);
+  }
+
+  if(rc < 0){
+    captureError = std::string("microphone read failed: ")
+      + snd_strerror(rc);
+    return false;
+  }
+  return true;
+}
+
+bool Microphone::readPeriodMmap(std::vector<int16_t>& dest){
+  snd_pcm_uframes_t got = 0;
+  while(got < frames){
+    //Capture in mmap mode has to be started by hand, including after
+    // recovering from an overrun
+    if(snd_pcm_state(handle) == SND_PCM_STATE_PREPARED){
+      int rc = snd_pcm_start(handle);
+      if(rc < 0 && !recover(rc)) return false;
+    }
+    
+    snd_pcm_sframes_t avail = snd_pcm_avail_update(handle);
+    if(avail < 0){
+      if(!recover(avail)) return false;
+      //Overrun. Whatever we had of this period is stale now
+      got = 0;
+      continue;
+    }
+    if(avail == 0){
+      int rc = snd_pcm_wait(handle, 1000);
+      if(rc < 0){
+	if(!recover(rc)) return false;
+	got = 0;
+      }
+      continue;
+    }
+
+    const snd_pcm_channel_area_t* areas;
+    snd_pcm_uframes_t offset;
+    snd_pcm_uframes_t n = frames - got;
+    int rc = snd_pcm_mmap_begin(handle, &areas, &offset, &n);
+    if(rc < 0){
+      if(!recover(rc)) return false;
+      got = 0;
+      continue;
+    }
+
+    //Each channel area says where its first sample is, and how far apart
+    // its samples are, in bits. For interleaved S16 that is one whole
+    // frame, but the plugin layer could hand us anything.
+    for(unsigned int ch=0; ch < channels; ch++){
+      const char* src = (const char*)areas[ch].addr
+	+ (areas[ch].first + offset*areas[ch].step)/8;
+      unsigned int step = areas[ch].step/8;
+      int16_t* out = dest.data() + ch*frames + got;
+      for(snd_pcm_uframes_t i=0; i < n; i++){
+	out[i] = *(const int16_t*)(src + i*step);
+      }
+    }
+
+    snd_pcm_sframes_t committed = snd_pcm_mmap_commit(handle, offset, n);
+    if(committed < 0 || (snd_pcm_uframes_t)committed != n){
+      if(!recover(committed >= 0 ? -EPIPE : committed)) return false;
+      got = 0;
+      continue;
+    }
+    got += n;
+  }
+  return true;
+}
+
+bool Microphone::readPeriod(std::vector<int16_t>& dest){
+  if(useMmap){
+    return readPeriodMmap(dest);
+  }
+  
+  snd_pcm_uframes_t got = 0;
+  while(got < frames){
+    int rc = snd_pcm_readi(handle,
+			   (char*)(interleaved.data() + got*channels),
+			   frames - got);
+    if(rc < 0){
+      if(!recover(rc)) return false;
+      //Overrun. Whatever we had of this period is stale now, so start over
+      got = 0;
+    } else {
+      got += rc;
+    }
+  }
+
+  for(unsigned int ch=0; ch < channels; ch++){
+    int16_t* out = dest.data() + ch*frames;
+    for(snd_pcm_uframes_t i=0; i < frames; i++){
+      out[i] = interleaved[i*channels + ch];
+    }
+  }
+  return true;
+}
+
+void Microphone::captureLoop(){
+  while(capturing){
+    std::vector<int16_t>* slot = ring->writeSlot();
+    bool keep = (slot != nullptr);
+    if(!keep){
+      //Processing has fallen behind. Keep draining ALSA anyway.
+      slot = &scratch;
+    }
+
+    if(!readPeriod(*slot)){
+      failed = true;
+      ring->wakeConsumer();
+      return;
+    }
+
+    captured++;
+    if(keep){
+      ring->commitWrite();
+    } else {
+      dropped++;
+    }
+  }
+}
+
+bool Microphone::read(std::vector<int16_t>& buffer, unsigned int timeoutMs){
+  if(ring->pop(buffer, timeoutMs)){
+    return true;
+  }
+  if(failed){
+    throw captureError;
+  }
+  return false;
+}
+
+CaptureStats Microphone::stats() const {
+  CaptureStats ret;
+  ret.occupancy = ring->occupancy();
+  ret.capacity = ring->capacity();
+  ret.captured = captured;
+  ret.overruns = overruns;
+  ret.dropped = dropped;
+  return ret;
+}
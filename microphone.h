@@ -39,8 +39,19 @@
 
 #include <vector>
 #include <cstdint>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <memory>
+
+#include "frameRing.h"
+#include "settings.h"
 
 /*! Class to manage an ALSA microphone 
+ *
+ * A dedicated capture thread does nothing but read periods from ALSA into
+ * a FrameRing, so that slow processing of one period does not cause the
+ * microphone to overrun. The processing loop takes periods out with read().
  *
  * \note Singleton, with lazy initialization. (Meyers style singleton) 
  *
@@ -50,15 +61,19 @@
  */
 class Microphone {
  public:
-  /*! Return the singleton instance. */
-  static Microphone& getInstance(){
-    static Microphone instance;
+  /*! Return the singleton instance.
+   *
+   * \param settings only used the first time this is called, when the
+   *        microphone is opened
+   */
+  static Microphone& getInstance(const Settings& settings){
+    static Microphone instance(settings);
     return instance;
   }
   
  private:
   //ctor and dtor are private to encourage correct usage of singleton
-  Microphone();
+  Microphone(const Settings& settings);
   ~Microphone();
 
  public:
@@ -77,7 +92,64 @@ class Microphone {
   unsigned int channels;
   /*! Rate of the signal, in samples per second */
   unsigned int rate;
+  /*! True if we capture through the mmap interface rather than
+   *  snd_pcm_readi. Each period is split into channels straight out of
+   *  the DMA area into its ring slot. snd_pcm_readi has to copy the
+   *  period into an interleaved buffer first, and split it from there. */
+  bool useMmap;
+
+  /*! Get the next period of sound from the capture thread, blocking
+   *  until one is available.
+   *
+   * \param buffer receives the period, frames*channels samples, one
+   *        channel after the other: channel ch is
+   *        [ch*frames, (ch+1)*frames). Must already be that size; its old
+   *        storage is recycled into the ring rather than freed.
+   * \param timeoutMs give up after this many milliseconds
+   * \return false if nothing arrived before the timeout
+   */
+  bool read(std::vector<int16_t>& buffer, unsigned int timeoutMs);
+
+  /*! Snapshot of the capture thread counters */
+  CaptureStats stats() const;
+
+ private:
+  /*! Body of the capture thread */
+  void captureLoop();
+
+  /*! Read exactly one period from ALSA into dest, one channel after the
+   *  other, recovering from overruns
+   *
+   * \return false if the read failed and capture should stop
+   */
+  bool readPeriod(std::vector<int16_t>& dest);
+  /*! Version of readPeriod for mmap access. Copies each channel out of
+   *  the DMA area into its place in dest. */
+  bool readPeriodMmap(std::vector<int16_t>& dest);
+  /*! Try to get the device running again after an error code from ALSA
+   *
+   * \return false (and set captureError) if it can't be recovered
+   */
+  bool recover(int rc);
+
+  /*! Periods handed from the capture thread to the processing loop */
+  std::unique_ptr<FrameRing> ring;
+  /*! Where periods go when the ring is full. They still have to be read,
+   *  or ALSA will overrun. */
+  std::vector<int16_t> scratch;
+  /*! Where snd_pcm_readi puts each period, interleaved, before it is
+   *  split into the ring slot. Not used with mmap. */
+  std::vector<int16_t> interleaved;
+
+  std::thread captureThread;
+  std::atomic<bool> capturing;
+  
+  std::atomic<unsigned long> captured;
+  std::atomic<unsigned long> overruns;
+  std::atomic<unsigned long> dropped;
 
-  /*! Buffer for storing the most recently read sound clip */
-  std::vector<int16_t> buffer;
+  /*! Set by the capture thread if ALSA fails in a way we can't recover
+   *  from. Rethrown from read() on the processing thread. */
+  std::string captureError;
+  std::atomic<bool> failed;
 };
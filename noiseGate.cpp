@@ -0,0 +1,82 @@
+/** \file noiseGate.cpp
+ * Noise floor tracking and gating, see noiseGate.h.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include "noiseGate.h"
+
+#include <algorithm>
+#include <cmath>
+
+NoiseGate::NoiseGate(float secondsPerFrame) :
+  fallRate(1.0f - std::exp(-secondsPerFrame/NOISE_FLOOR_FALL_SECONDS)),
+  riseRate(1.0f - std::exp(-secondsPerFrame/NOISE_FLOOR_RISE_SECONDS)),
+  holdFrames(std::max(1L,
+		      std::lround(GATE_HOLD_SECONDS/secondsPerFrame))),
+  hold(0) {
+}
+
+bool NoiseGate::update(const std::vector<std::pair<float, float> >& stats,
+		       float loudness){
+  unsigned int channels = std::min<unsigned int>(stats.size(), MAX_CHANNELS);
+  bool first = counters.frames == 0 || channels != counters.channels;
+  counters.channels = channels;
+  counters.frames++;
+
+  //Compare against the floors from before this frame, so a sudden sound
+  // is measured against the quiet that came before it
+  bool above = false;
+  for(unsigned int i=0; i < channels; i++){
+    float level = stats[i].second;
+    float& floor = counters.noiseFloor[i];
+    if(first){
+      floor = level;
+      continue;
+    }
+    if(level > GATE_RATIO*floor){
+      above = true;
+    }
+    float rate = level < floor ? fallRate : riseRate;
+    floor += rate*(level - floor);
+  }
+
+  if(loudness < SILENCE_LOUDNESS){
+    hold = 0;
+    counters.gated++;
+    counters.silent++;
+    return false;
+  }
+  if(above || first){
+    hold = holdFrames;
+    return true;
+  }
+  if(hold > 0){
+    hold--;
+    return true;
+  }
+  counters.gated++;
+  return false;
+}
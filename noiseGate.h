@@ -0,0 +1,114 @@
+/** \file noiseGate.h
+ * Decides, before any delays are estimated, whether a frame has anything
+ * in it worth localizing.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <utility>
+
+#include "constants.h"
+
+/*! A channel must be this many times louder (in standard deviation) than
+ *  its noise floor to open the gate. 2 is about 6 dB. */
+constexpr float GATE_RATIO = 2.0f;
+
+/*! Time constant, in seconds, of the noise floor falling to a quieter
+ *  level. Quiet frames are trusted quickly. */
+constexpr float NOISE_FLOOR_FALL_SECONDS = 0.1f;
+
+/*! Time constant, in seconds, of the noise floor rising to a louder
+ *  level. Slow, so that a sound doesn't become part of the floor while
+ *  it is going on, but a steady hum does within several seconds. */
+constexpr float NOISE_FLOOR_RISE_SECONDS = 6.5f;
+
+/*! Seconds the gate stays open after the last frame that opened it, so
+ *  the quiet tail of a sound still gets localized */
+constexpr float GATE_HOLD_SECONDS = 0.13f;
+
+/*! Counters from the NoiseGate, for the /gate.json endpoint */
+struct GateStats {
+  /*! Number of frames looked at */
+  unsigned long frames = 0;
+  /*! Number of those that were gated, and so never localized */
+  unsigned long gated = 0;
+  /*! Of the gated frames, how many were quieter than SILENCE_LOUDNESS,
+   *  which the Tracker would have thrown away anyway */
+  unsigned long silent = 0;
+  /*! Number of entries of noiseFloor in use */
+  unsigned int channels = 0;
+  /*! Current noise floor of each channel, as a standard deviation */
+  std::array<float, MAX_CHANNELS> noiseFloor = {};
+};
+
+/*! Per channel noise floor tracker and gate
+ *
+ * The floor of each channel follows the channel's standard deviation,
+ * falling quickly and rising slowly, so it settles on the quiet level
+ * between sounds. A frame is passed on if its loudest channel is at
+ * least SILENCE_LOUDNESS and some channel is GATE_RATIO above its floor.
+ * Anything else would at best give the Tracker a point it drops, or a
+ * direction for background noise.
+ */
+class NoiseGate {
+ public:
+  /*! A gate for frames that come in at a steady rate
+   *
+   * \param secondsPerFrame time between the starts of consecutive
+   *        frames, which is the hop when windows overlap. The floor's
+   *        rates and the hold are per frame, so they are worked out from
+   *        this to keep the same timing in seconds.
+   */
+  explicit NoiseGate(float secondsPerFrame);
+
+  /*! Update the noise floors with a new frame, and decide whether to
+   *  localize it
+   *
+   * \param stats mean and standard deviation of each channel, as from
+   *        meansAndStdDevs
+   * \param loudness standard deviation of the loudest channel
+   * \return true if the frame should be localized
+   */
+  bool update(const std::vector<std::pair<float, float> >& stats,
+	      float loudness);
+
+  /*! Counters so far, and the current noise floors */
+  const GateStats& stats() const { return counters; }
+
+ private:
+  GateStats counters;
+  /*! How far the floor moves toward a quieter frame, per frame */
+  float fallRate;
+  /*! How far the floor moves toward a louder frame, per frame */
+  float riseRate;
+  /*! Frames the gate stays open after the last frame that opened it */
+  unsigned int holdFrames;
+  /*! Frames left before the gate closes, if nothing opens it again */
+  unsigned int hold;
+};
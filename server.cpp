@@ -39,6 +39,8 @@
  *  this is the best design.
  **/
 
+#include <array>
+#include <algorithm>
 #include <thread>
 #include <mutex>
 #include <fstream>
@@ -102,6 +104,10 @@ void Server::operator() (http_server::request const &request,
 
       response_str += "        \"loudness\": ";
       response_str += std::to_string(sounds[i].loudness);
+      response_str += ",\n";
+
+      response_str += "        \"bands\": ";
+      response_str += std::to_string(sounds[i].bands);
       response_str += "\n";
     }
     if(prev_entry){
@@ -109,6 +115,56 @@ void Server::operator() (http_server::request const &request,
     }
     response_str += "]\n}\n";
     
+    response = http_server::response::stock_reply
+      (http_server::response::ok, response_str);
+
+    http_server::response_header content_header;
+    content_header.name = "Content-Type";
+    content_header.value = "application/json";
+    response.headers.push_back(content_header);
+  } else if(command.find("capture.json") == 1){
+    std::lock_guard<std::mutex> guard(g_buffer_mutex);
+
+    std::string response_str = "{\n";
+    response_str += "    \"occupancy\": "
+      + std::to_string(captureStats.occupancy) + ",\n";
+    response_str += "    \"capacity\": "
+      + std::to_string(captureStats.capacity) + ",\n";
+    response_str += "    \"captured\": "
+      + std::to_string(captureStats.captured) + ",\n";
+    response_str += "    \"overruns\": "
+      + std::to_string(captureStats.overruns) + ",\n";
+    response_str += "    \"dropped\": "
+      + std::to_string(captureStats.dropped) + "\n";
+    response_str += "}\n";
+
+    response = http_server::response::stock_reply
+      (http_server::response::ok, response_str);
+
+    http_server::response_header content_header;
+    content_header.name = "Content-Type";
+    content_header.value = "application/json";
+    response.headers.push_back(content_header);
+  } else if(command.find("gate.json") == 1){
+    std::lock_guard<std::mutex> guard(g_buffer_mutex);
+
+    std::string response_str = "{\n";
+    response_str += "    \"frames\": "
+      + std::to_string(gateStats.frames) + ",\n";
+    response_str += "    \"gated\": "
+      + std::to_string(gateStats.gated) + ",\n";
+    response_str += "    \"silent\": "
+      + std::to_string(gateStats.silent) + ",\n";
+    response_str += "    \"noise_floor\": [";
+    for(unsigned int i=0; i < gateStats.channels; i++){
+      response_str += std::to_string(gateStats.noiseFloor[i]);
+      if(i + 1 < gateStats.channels){
+	response_str += ", ";
+      }
+    }
+    response_str += "]\n";
+    response_str += "}\n";
+
     response = http_server::response::stock_reply
       (http_server::response::ok, response_str);
 
@@ -140,23 +196,35 @@ void Server::operator() (http_server::request const &request,
     
     std::string response_str
       = "<svg  xmlns=\"http://www.w3.org/2000/svg\" width=\"";
-    response_str += std::to_string(4*(int)(0.5f + 16000.0f/TARGET_FRAME_RATE));
-    response_str += "\" height=\"800\">\n";
-
-    std::vector<std::string> colors = {"red", "green", "blue", "black"};
+    response_str += std::to_string(4*(int)(0.5f + SAMPLES_PER_SECOND/TARGET_FRAME_RATE));
+    response_str += "\" height=\"";
+    //The grid of pair correlations below starts at y = 300, one row of
+    // 100 per channel
+    response_str += std::to_string(std::max(800u, 350 + 100*frame.channels()));
+    response_str += "\">\n";
+
+    //One colour per channel, for as many channels as there can be
+    static const std::array<const char*, MAX_CHANNELS> colors = {
+      "red", "green", "blue", "black", "orange", "purple", "teal", "brown",
+      "magenta", "olive", "navy", "maroon", "gray", "lime", "cyan", "gold"
+    };
+    unsigned int channels = frame.channels();
+    //Delays that came with this frame, if there are any yet
+    bool aligned = offsets.size() == numPairs(channels);
 
     if(loudness < 1.0f) loudness = 1.0f;
 
-    if(buffer.size() > 0){
-      for(int i=0; i<colors.size(); i++){
+    if(frame.frames() > 0){
+      for(unsigned int i=0; i < channels; i++){
 	response_str += "  <polyline points=\"";
 	int offset = 0;
-	if(i != 0){
-	  offset = offsets[i-1];
+	if(i != 0 && aligned){
+	  offset = offsets[pairIndex(0, i, channels)];
 	}
 	int x = 0;
-	for(int j=i; j < buffer.size(); j += NUM_CHANNELS){
-	  int16_t val = buffer[j];
+	const int16_t* samples = frame.samples(i);
+	for(int j=0; j < frame.frames(); j++){
+	  int16_t val = samples[j];
 	  response_str += std::to_string(x + 4*offset) + ","
 	    + std::to_string(50 + (val/(4*loudness))*50) + " ";
 	  
@@ -173,9 +241,9 @@ void Server::operator() (http_server::request const &request,
 
     int corr_x = 100;
     int corr_y = 300;
-    if(buffer.size() > 0){
-      for(int i=0; i<colors.size(); i++){
-	auto autocorr = xcorr(buffer,
+    if(frame.frames() > 0){
+      for(unsigned int i=0; i < channels; i++){
+	auto autocorr = xcorr(frame,
 			      i, i, 2*SENSOR_SPACING_SAMPLES);
 	float max = 1.0f;
 	for(int j=0; j < autocorr.size(); j++){
@@ -210,10 +278,10 @@ void Server::operator() (http_server::request const &request,
     response_str += "black";
     response_str += ";stroke-width:1\" />\n";
 
-    if(buffer.size() > 0){
-      for(int ch1=0; ch1<colors.size(); ch1++){
-	for(int ch2=0; ch2 < colors.size(); ch2++){
-	  auto autocorr = xcorr(buffer,
+    if(frame.frames() > 0){
+      for(unsigned int ch1=0; ch1 < channels; ch1++){
+	for(unsigned int ch2=0; ch2 < channels; ch2++){
+	  auto autocorr = xcorr(frame,
 				ch1, ch2, 2*SENSOR_SPACING_SAMPLES);
 	  float max = 1.0f;
 	  for(int j=0; j < autocorr.size(); j++){
@@ -269,7 +337,7 @@ void Server::operator() (http_server::request const &request,
 	  response_str += ";stroke-width:1\" />\n";
 
 	  
-	  std::pair<float, float> delay_ = delay(buffer,
+	  std::pair<float, float> delay_ = delay(frame,
 						 ch1, ch2,
 						 SENSOR_SPACING_SAMPLES*2);
 	  response_str += "<circle cx=\""
@@ -338,15 +406,28 @@ Server::~Server(){
   }
 }
 
-void Server::putBuffer(std::vector<int16_t> &ibuffer, float iloudness,
-		       std::vector<float> ioffsets){
+void Server::putBuffer(SoundFrame &iframe, float iloudness,
+		       const std::vector<float>& idelays){
   std::lock_guard<std::mutex> guard(g_buffer_mutex);
 
-  offsets = ioffsets;
-  buffer = ibuffer;
+  offsets = idelays;
+  //The first time through, the caller gets back an empty frame, which
+  // allocates on its next set(). After that the two frames just trade
+  // places.
+  frame.swap(iframe);
   loudness = iloudness;
 }
 
+void Server::putCaptureStats(const CaptureStats& istats){
+  std::lock_guard<std::mutex> guard(g_buffer_mutex);
+  captureStats = istats;
+}
+
+void Server::putGateStats(const GateStats& istats){
+  std::lock_guard<std::mutex> guard(g_buffer_mutex);
+  gateStats = istats;
+}
+
 void Server::tickTo(unsigned long iframeNum){
   std::lock_guard<std::mutex> guard(g_buffer_mutex);
   frameNumber = iframeNum;
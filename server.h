@@ -35,6 +35,9 @@
 #include <cstdint>
 
 #include "tracker.h"
+#include "frameRing.h"
+#include "soundFrame.h"
+#include "noiseGate.h"
 
 #include <boost/network/protocol/http/server.hpp>
 namespace http = boost::network::http;
@@ -80,16 +83,31 @@ class Server {
    *  for remote kill/restart of the server. Otherwise, return true */
   bool isRunning();
 
-  /*! For debugging purposes, provide a copy of the sound data to the
+  /*! For debugging purposes, provide the sound data to the
    *   server.
    *
-   * \param ibuffer a sound clip, assumed to be 4 channels, interleaved
+   * \param iframe a sound clip, already split into channels.
+   *        Not copied: it is swapped with the server's previous clip,
+   *        so on return iframe holds older data.
    * \param iloudness the standard deviation of the loudest channel
-   * \param loc The delays for channels 1, 2, and 3 vs. channel 0. Used
-   *        for drawing the 4 channels correctly aligned
+   * \param delays delays of the clip, delays[pairIndex(i, j, n)] for the
+   *        n channels of iframe, as offsets in main. Those against channel
+   *        0 are used for drawing every channel correctly aligned.
    */
-  void putBuffer(std::vector<int16_t> &ibuffer, float iloudness,
-		 std::vector<float> loc);
+  void putBuffer(SoundFrame &iframe, float iloudness,
+		 const std::vector<float>& delays);
+
+  /*! Provide the latest capture thread counters, so they can be served
+   *  from the /capture.json endpoint.
+   *
+   * \param istats counters from Microphone::stats */
+  void putCaptureStats(const CaptureStats& istats);
+
+  /*! Provide the latest noise gate counters, so they can be served from
+   *  the /gate.json endpoint.
+   *
+   * \param istats counters from NoiseGate::stats */
+  void putGateStats(const GateStats& istats);
 
   /*! Notify the server of which frame number the microphone has just
    *  delivered. Should be called once for each time snd_pcm_readi is
@@ -99,11 +117,13 @@ class Server {
   void tickTo(unsigned long iframeNum);
 
  private:
-  std::vector<int16_t> buffer;
+  SoundFrame frame;
   std::vector<float> offsets;
 
   float loudness;
   unsigned long frameNumber;
+  CaptureStats captureStats;
+  GateStats gateStats;
   unsigned long frameNumberLastSentData = -1;
   
   http_server* p_server = nullptr;
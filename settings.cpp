@@ -0,0 +1,122 @@
+/** \file settings.cpp
+ * Run time options, taken from the command line.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include "settings.h"
+#include "coarseSearch.h"
+#include "sourceAssociation.h"
+#include "bandLocalizer.h"
+
+#include <string>
+#include <cstdlib>
+#include <cerrno>
+#include <climits>
+
+/*! A positive whole number from an option's value
+ *
+ * \note Throws a std::string if it isn't one
+ */
+static unsigned int parseCount(const std::string& value){
+  //strtoul would skip spaces, and wrap "-1" round to a huge number
+  if(value.empty() || value[0] < '0' || value[0] > '9'){
+    throw std::string("expected a positive number, got ") + value;
+  }
+  char* end = nullptr;
+  errno = 0;
+  unsigned long ret = std::strtoul(value.c_str(), &end, 10);
+  if(*end != '\0' || ret == 0){
+    throw std::string("expected a positive number, got ") + value;
+  }
+  if(errno == ERANGE || ret > UINT_MAX){
+    throw value + std::string(" is too big");
+  }
+  return (unsigned int)ret;
+}
+
+Settings parseSettings(int argc, char* argv[]){
+  Settings ret;
+
+  for(int i=1; i < argc; i++){
+    std::string arg = argv[i];
+
+    if(arg == "--mmap"){
+      ret.useMmap = true;
+    } else if(arg == "--remove-dc"){
+      ret.removeDC = true;
+    } else if(arg == "--engine=time"){
+      ret.engine = DelayEngine::TIME_DOMAIN;
+    } else if(arg == "--engine=gcc"){
+      ret.engine = DelayEngine::GCC;
+    } else if(arg == "--engine=gcc-phat"){
+      ret.engine = DelayEngine::GCC_PHAT;
+    } else if(arg == "--subsample"){
+      ret.subsample = true;
+    } else if(arg == "--gate"){
+      ret.gate = true;
+    } else if(arg.compare(0, 9, "--window=") == 0){
+      ret.window = parseCount(arg.substr(9));
+    } else if(arg.compare(0, 6, "--hop=") == 0){
+      ret.hop = parseCount(arg.substr(6));
+    } else if(arg == "--coarse"){
+      ret.coarseCandidates = COARSE_CANDIDATES;
+    } else if(arg.compare(0, 9, "--coarse=") == 0){
+      ret.coarseCandidates = parseCount(arg.substr(9));
+    } else if(arg.compare(0, 10, "--sources=") == 0){
+      ret.sources = parseCount(arg.substr(10));
+      if(ret.sources > MAX_SOURCES){
+	throw std::string("--sources can be at most ")
+	  + std::to_string(MAX_SOURCES);
+      }
+    } else if(arg.compare(0, 8, "--bands=") == 0){
+      ret.bands = parseCount(arg.substr(8));
+      if(ret.bands > MAX_BANDS){
+	throw std::string("--bands can be at most ")
+	  + std::to_string(MAX_BANDS);
+      }
+    } else if(arg == "--solver=lut"){
+      ret.solver = DirectionSolver::LUT;
+    } else if(arg == "--solver=ls"){
+      ret.solver = DirectionSolver::LEAST_SQUARES;
+    } else if(arg == "--solver=srp"){
+      ret.solver = DirectionSolver::SRP;
+    } else if(arg.compare(0, 13, "--export-lut=") == 0){
+      ret.exportLUT = arg.substr(13);
+    } else if(arg.compare(0, 11, "--geometry=") == 0){
+      ret.geometryFile = arg.substr(11);
+    } else if(arg.compare(0, 15, "--capture-rate=") == 0){
+      ret.captureRate = parseCount(arg.substr(15));
+      if(ret.captureRate % SAMPLES_PER_SECOND != 0){
+	throw std::string("capture rate must be a multiple of ")
+	  + std::to_string(SAMPLES_PER_SECOND);
+      }
+    } else {
+      throw std::string("unknown option: ") + arg;
+    }
+  }
+
+  return ret;
+}
@@ -0,0 +1,124 @@
+/** \file settings.h
+ * Run time options, taken from the command line.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#pragma once
+
+#include <string>
+
+#include "constants.h"
+
+/*! Which method to use for estimating the delay between two channels */
+enum class DelayEngine {
+  /*! Dot product at every lag, see xcorr in soundProcessing.h */
+  TIME_DOMAIN,
+  /*! Cross correlation through the FFT, see GccPhat */
+  GCC,
+  /*! Cross correlation through the FFT, with PHAT weighting */
+  GCC_PHAT
+};
+
+/*! How the channel delays are turned into a direction */
+enum class DirectionSolver {
+  /*! Look up the three delays against channel 0 in LocationLUT. Only
+   *  for 4 microphones no further apart than MAX_OFFSET samples */
+  LUT,
+  /*! Least squares fit to the delays of all pairs, see TdoaSolver */
+  LEAST_SQUARES,
+  /*! Best direction of a sphere grid against the correlation curves of
+   *  all pairs, see SrpLocator */
+  SRP
+};
+
+/*! Options that can be changed without recompiling. Defaults reproduce
+ *  the original behavior of the program. */
+struct Settings {
+  /*! Use ALSA mmap access for capture, instead of snd_pcm_readi
+   *  (--mmap). Periods are split into channels straight out of the DMA
+   *  area, instead of being copied out interleaved first. */
+  bool useMmap = false;
+  /*! How channel delays are estimated (--engine=time|gcc|gcc-phat) */
+  DelayEngine engine = DelayEngine::TIME_DOMAIN;
+  /*! Subtract each channel's mean before estimating delays
+   *  (--remove-dc) */
+  bool removeDC = false;
+  /*! Refine delays to a fraction of a sample by fitting a parabola to
+   *  the correlation peak (--subsample). Best with the least squares
+   *  solver, or a LUT_KEY_PREC of 2 or more. */
+  bool subsample = false;
+  /*! Skip delay estimation and direction finding on frames with nothing
+   *  above the noise floor (--gate). See NoiseGate. */
+  bool gate = false;
+  /*! Samples in each analysis window (--window=N). 0 means one period,
+   *  which is the original behaviour. Must be at least twice the longest
+   *  delay searched for, plus a little. */
+  unsigned int window = 0;
+  /*! Samples between the starts of consecutive windows (--hop=N). 0
+   *  means the same as the window, so windows don't overlap. A hop of a
+   *  quarter of the window gives four times as many directions. See
+   *  SlidingWindow. */
+  unsigned int hop = 0;
+  /*! If not 0, the time domain engine searches for each delay coarse to
+   *  fine, refining this many coarse peaks (--coarse, or --coarse=K).
+   *  0 searches every lag at the full rate. See CoarseSearch. Only valid
+   *  with DelayEngine::TIME_DOMAIN. */
+  unsigned int coarseCandidates = 0;
+  /*! Most sounds to locate in each window (--sources=N). Above 1, the
+   *  top peaks of every pair are sorted into consistent sets of delays,
+   *  one per sound. See SourceAssociator. */
+  unsigned int sources = 1;
+  /*! If not 0, split the spectrum into this many bands and find a
+   *  direction in each one, in parallel (--bands=N). Replaces the delay
+   *  engine with GCC-PHAT per band. See BandLocalizer. */
+  unsigned int bands = 0;
+  /*! How delays become a direction (--solver=lut|ls|srp) */
+  DirectionSolver solver = DirectionSolver::LUT;
+  /*! If not empty, write the location lookup table to this file as text
+   *  at startup (--export-lut=FILE) */
+  std::string exportLUT;
+  /*! If not empty, read the microphone positions from this file instead
+   *  of using the built in tetrahedron (--geometry=FILE). See
+   *  loadMicLocations. */
+  std::string geometryFile;
+  /*! Number of channels to capture. Not an option itself, main sets it to
+   *  the number of microphones in the geometry. */
+  unsigned int channels = NUM_CHANNELS;
+  /*! Rate to capture at (--capture-rate=N). Must be a whole multiple of
+   *  SAMPLES_PER_SECOND. Anything higher is band limited and decimated
+   *  down to SAMPLES_PER_SECOND before delays are estimated. */
+  unsigned int captureRate = SAMPLES_PER_SECOND;
+};
+
+/*! Build the Settings from the command line
+ *
+ * \param argc as passed to main
+ * \param argv as passed to main
+ * \return the settings, with defaults for anything not mentioned
+ *
+ * \note Throws a std::string if an option is not recognized
+ */
+Settings parseSettings(int argc, char* argv[]);
@@ -0,0 +1,178 @@
+/** \file slidingWindow.cpp
+ * Overlapping analysis windows, see slidingWindow.h.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include "slidingWindow.h"
+#include "xcorrKernels.h"
+#include "constants.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+SlidingWindow::SlidingWindow(unsigned int window, unsigned int hop,
+			     unsigned int channels, int maxRange,
+			     unsigned int maxPush) :
+  window(window), hop(hop), channels(channels),
+  capacity(window + hop + maxPush),
+  history(2*channels*capacity, 0),
+  pushed(0), start(0), started(false),
+  totals(channels, 0), squares(channels, 0), channelStats(channels),
+  sums(numPairs(channels)*(2*maxRange + 1), 0),
+  entering(maxRange + 1, 0), leaving(maxRange + 1, 0),
+  sumsStart(0), sumsRange(0), sumsValid(false) {
+  if(hop == 0 || hop > window){
+    throw std::string("hop must be between 1 and the window size");
+  }
+}
+
+void SlidingWindow::push(const std::vector<int16_t>& buffer){
+  unsigned int frames = buffer.size()/channels;
+  for(unsigned int ch=0; ch < channels; ch++){
+    int16_t* ring = history.data() + ch*2*capacity;
+    const int16_t* in = buffer.data() + ch*frames;
+    for(unsigned int i=0; i < frames; i++){
+      unsigned int pos = (pushed + i) % capacity;
+      ring[pos] = ring[pos + capacity] = in[i];
+    }
+  }
+  pushed += frames;
+}
+
+bool SlidingWindow::next(){
+  if(!started){
+    if(pushed < window){
+      return false;
+    }
+    start = pushed - window;
+    for(unsigned int ch=0; ch < channels; ch++){
+      const int16_t* x = at(ch, start);
+      totals[ch] = squares[ch] = 0;
+      for(unsigned int i=0; i < window; i++){
+	totals[ch] += x[i];
+	squares[ch] += (int32_t)x[i]*x[i];
+      }
+    }
+    started = true;
+    updateStats();
+    return true;
+  }
+  
+  if(start + hop + window > pushed){
+    return false;
+  }
+  for(unsigned int ch=0; ch < channels; ch++){
+    //The first hop of the old window leaves, the hop after it enters
+    const int16_t* x = at(ch, start);
+    for(unsigned int i=0; i < hop; i++){
+      int16_t out = x[i];
+      int16_t in = x[window + i];
+      totals[ch] += in - out;
+      squares[ch] += (int32_t)in*in - (int32_t)out*out;
+    }
+  }
+  start += hop;
+  updateStats();
+  return true;
+}
+
+void SlidingWindow::updateStats(){
+  //Same arithmetic as SoundFrame::set, so the answers match exactly
+  for(unsigned int ch=0; ch < channels; ch++){
+    double avg = (double)totals[ch]/window;
+    double var = (double)squares[ch]/window - avg*avg;
+    channelStats[ch] = std::make_pair((float)avg,
+				      (float)std::sqrt(std::max(var, 0.0)));
+  }
+}
+
+void SlidingWindow::correlate(int range, PairCorrelations& out){
+  const unsigned int numLags = 2*range + 1;
+  const unsigned int pairs = numPairs(channels);
+  
+  if(sumsValid && sumsRange == range && sumsStart + hop == start
+     && hop + range <= window){
+    //Pair (i, i+lag) is in a window if both samples are. Sliding forward,
+    // the pairs that leave are the ones whose earlier sample was in the
+    // first hop of the old window, and the ones that enter are the ones
+    // whose later sample is in the hop after it. Indices are relative to
+    // the old window.
+    for(unsigned int a=0; a < channels; a++){
+      for(unsigned int b=a+1; b < channels; b++){
+	const int16_t* x = at(a, sumsStart);
+	const int16_t* y = at(b, sumsStart);
+	int64_t* s = sums.data() + pairIndex(a, b, channels)*numLags + range;
+
+	//Lags 0 to range: y is the later sample
+	xcorrRangeSums(y, x, window, window + hop, -range, range + 1,
+		       entering.data());
+	xcorrRangeSums(x, y, 0, hop, 0, range + 1, leaving.data());
+	for(int lag=0; lag <= range; lag++){
+	  s[lag] += entering[range - lag] - leaving[lag];
+	}
+
+	//Lags -range to -1: x is the later sample
+	xcorrRangeSums(x, y, window, window + hop, -range, range,
+		       entering.data());
+	xcorrRangeSums(y, x, 0, hop, 1, range, leaving.data());
+	for(int lag=-range; lag < 0; lag++){
+	  s[lag] += entering[lag + range] - leaving[-lag - 1];
+	}
+      }
+    }
+  } else if(!(sumsValid && sumsRange == range && sumsStart == start)){
+    const int16_t* ch[MAX_CHANNELS];
+    for(unsigned int i=0; i < channels; i++){
+      ch[i] = at(i, start);
+    }
+    if(channels == 4){
+      xcorrSumsAllPairs(ch, window, -range, numLags, sums.data());
+    } else {
+      for(unsigned int a=0; a < channels; a++){
+	for(unsigned int b=a+1; b < channels; b++){
+	  xcorrSums(ch[a], ch[b], window, -range, numLags,
+		    sums.data() + pairIndex(a, b, channels)*numLags);
+	}
+      }
+    }
+  }
+  sumsStart = start;
+  sumsRange = range;
+  sumsValid = true;
+
+  out.range = range;
+  std::copy(sums.begin(), sums.begin() + pairs*numLags, out.sums.begin());
+  normalizeCorrelations(window, squares.data(), out);
+}
+
+void SlidingWindow::copyTo(SoundFrame& frame, bool removeDC) const {
+  const int16_t* ch[MAX_CHANNELS];
+  for(unsigned int i=0; i < channels; i++){
+    ch[i] = at(i, start);
+  }
+  frame.set(ch, window, channels, removeDC);
+}
@@ -0,0 +1,155 @@
+/** \file slidingWindow.h
+ * Overlapping analysis windows over a history of recent samples.
+ *
+ * Instead of one direction per ALSA period, the main loop can look at a
+ * window of the most recent samples every time a hop's worth of new
+ * samples has come in. With a hop of a quarter of the window, that is
+ * four times as many directions per second. The statistics and the time
+ * domain correlations are updated by adding the hop that entered the
+ * window and subtracting the hop that left it, so each window costs about
+ * 2*hop/window of computing it from scratch.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+#include "soundFrame.h"
+#include "soundProcessing.h"
+
+/*! Sample history with a window that slides forward one hop at a time
+ *
+ * Samples are kept in a ring per channel, with every sample written
+ * twice, at i and i+capacity. Any stretch of up to capacity samples is
+ * then in one piece, so the kernels can run on it directly.
+ *
+ * All sums are 64 bit integers, which are exact, so sliding never drifts:
+ * every window gives bit for bit the same stats and correlations as
+ * copying it into a SoundFrame and calling correlateAllPairs.
+ */
+class SlidingWindow {
+ public:
+  /*! Allocate the history
+   *
+   * \param window samples in each window
+   * \param hop samples between the starts of consecutive windows, 1 to
+   *        window
+   * \param channels number of channels
+   * \param maxRange largest range that will be passed to correlate
+   * \param maxPush most frames that will be passed to push at once
+   *
+   * \note Throws a std::string if hop is 0 or more than window
+   */
+  SlidingWindow(unsigned int window, unsigned int hop, unsigned int channels,
+		int maxRange, unsigned int maxPush);
+
+  /*! Add new samples to the history
+   *
+   * \param buffer samples of each channel in turn, as Microphone::read
+   *        gives them, at most maxPush frames. Call next until it returns
+   *        false before pushing again.
+   */
+  void push(const std::vector<int16_t>& buffer);
+
+  /*! Move to the next window, if enough samples have arrived
+   *
+   * \return true if there is a new window to analyse
+   */
+  bool next();
+
+  /*! Mean (first) and standard deviation (second) of each channel over
+   *  the current window, like meansAndStdDevs */
+  const std::vector<std::pair<float, float> >& stats() const {
+    return channelStats;
+  }
+
+  /*! Correlate every pair of channels over the current window, like
+   *  correlateAllPairs. If the previous window was correlated at the same
+   *  range and the hop leaves at least range samples of overlap, only the
+   *  entering and leaving hops are correlated. Otherwise the whole window
+   *  is. Does not allocate.
+   *
+   * \param range compute lags from -range to range, at most maxRange
+   * \param out receives the curves and energies. Must have been made for
+   *        this many channels.
+   */
+  void correlate(int range, PairCorrelations& out);
+
+  /*! Copy the current window into a frame, for the stages that need one
+   *
+   * \param frame receives the window
+   * \param removeDC as in SoundFrame::set
+   */
+  void copyTo(SoundFrame& frame, bool removeDC) const;
+
+  /*! True once there has been at least one window */
+  bool ready() const { return started; }
+
+  /*! Samples in each window */
+  const unsigned int window;
+  /*! Samples between the starts of consecutive windows */
+  const unsigned int hop;
+  /*! Number of channels */
+  const unsigned int channels;
+
+ private:
+  /*! Samples of channel ch from absolute sample number t on */
+  const int16_t* at(unsigned int ch, uint64_t t) const {
+    return history.data() + ch*2*capacity + t % capacity;
+  }
+  /*! Work out the stats of the window from the running sums */
+  void updateStats();
+  
+  /*! Samples each channel's ring holds */
+  const unsigned int capacity;
+  /*! Channel ch's ring is [ch*2*capacity, (ch+1)*2*capacity) */
+  std::vector<int16_t> history;
+  /*! Total samples pushed, per channel */
+  uint64_t pushed;
+  /*! Absolute sample number of the first sample in the current window */
+  uint64_t start;
+  /*! False until the first window */
+  bool started;
+
+  /*! Sum of the samples of each channel in the window */
+  std::vector<int64_t> totals;
+  /*! Sum of the squared samples of each channel in the window */
+  std::vector<int64_t> squares;
+  std::vector<std::pair<float, float> > channelStats;
+
+  /*! Running cross correlation sums, laid out as PairCorrelations::sums */
+  std::vector<int64_t> sums;
+  /*! Scratch space for the sums of one hop */
+  std::vector<int64_t> entering;
+  std::vector<int64_t> leaving;
+  /*! Window start and range that sums are for, if sumsValid */
+  uint64_t sumsStart;
+  int sumsRange;
+  bool sumsValid;
+};
@@ -0,0 +1,144 @@
+/** \file soundFrame.cpp
+ * One period of sound, split into separate channels once so that every
+ * processing stage can use it with unit stride.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include "soundFrame.h"
+#include "constants.h"
+
+#include <cmath>
+#include <algorithm>
+
+SoundFrame::SoundFrame() : numFrames(0), numChannels(0) {
+}
+
+SoundFrame::SoundFrame(unsigned int frames, unsigned int channels) :
+  numFrames(0), numChannels(0) {
+  resize(frames, channels);
+}
+
+SoundFrame::SoundFrame(const std::vector<int16_t>& buffer) :
+  numFrames(0), numChannels(0) {
+  set(buffer, NUM_CHANNELS);
+}
+
+void SoundFrame::resize(unsigned int frames, unsigned int channels){
+  if(frames == numFrames && channels == numChannels) return;
+  
+  numFrames = frames;
+  numChannels = channels;
+  planar.resize(frames*channels);
+  planarFloat.resize(frames*channels);
+  channelStats.resize(channels);
+}
+
+/*! Split one channel out of an interleaved buffer, and work out its
+ *  mean and standard deviation
+ *
+ * \tparam CHANNELS the stride of buffer, if it is known at compile time,
+ *         or 0 to use channels
+ */
+template <unsigned int CHANNELS>
+static std::pair<float, float>
+deinterleave(const int16_t* buffer, unsigned int channels, unsigned int ch,
+	     unsigned int frames, int16_t* out, float* fout){
+  const unsigned int stride = CHANNELS ? CHANNELS : channels;
+  
+  //Integer sums are exact, so the stats don't depend on the order
+  // samples are added in
+  int64_t total = 0;
+  int64_t totalSq = 0;
+  for(unsigned int i=0; i < frames; i++){
+    int16_t val = buffer[stride*i + ch];
+    out[i] = val;
+    fout[i] = (float)val;
+    total += val;
+    totalSq += (int32_t)val*val;
+  }
+
+  double avg = (double)total/frames;
+  double var = (double)totalSq/frames - avg*avg;
+  return std::make_pair((float)avg, (float)std::sqrt(std::max(var, 0.0)));
+}
+
+void SoundFrame::set(const std::vector<int16_t>& buffer,
+		     unsigned int channels, bool removeDC){
+  resize(buffer.size()/channels, channels);
+
+  for(unsigned int ch=0; ch < numChannels; ch++){
+    int16_t* out = planar.data() + ch*numFrames;
+    float* fout = planarFloat.data() + ch*numFrames;
+    if(channels == 4){
+      channelStats[ch] = deinterleave<4>(buffer.data(), channels, ch,
+					 numFrames, out, fout);
+    } else {
+      channelStats[ch] = deinterleave<0>(buffer.data(), channels, ch,
+					 numFrames, out, fout);
+    }
+  }
+
+  if(removeDC){
+    subtractMeans(channelStats);
+  }
+}
+
+void SoundFrame::set(const int16_t* const* channels, unsigned int frames,
+		     unsigned int channelCount, bool removeDC){
+  resize(frames, channelCount);
+
+  for(unsigned int ch=0; ch < numChannels; ch++){
+    //A planar channel is just an interleaved buffer with one channel
+    channelStats[ch] = deinterleave<1>(channels[ch], 1, 0, numFrames,
+				       planar.data() + ch*numFrames,
+				       planarFloat.data() + ch*numFrames);
+  }
+
+  if(removeDC){
+    subtractMeans(channelStats);
+  }
+}
+
+void SoundFrame::subtractMeans(const std::vector<std::pair<float, float> >&
+			       istats){
+  for(unsigned int ch=0; ch < numChannels; ch++){
+    float mean = istats[ch].first;
+    int16_t* out = planar.data() + ch*numFrames;
+    float* fout = planarFloat.data() + ch*numFrames;
+    for(unsigned int i=0; i < numFrames; i++){
+      fout[i] = (float)out[i] - mean;
+      out[i] = (int16_t)std::lround(fout[i]);
+    }
+  }
+}
+
+void SoundFrame::swap(SoundFrame& other){
+  std::swap(numFrames, other.numFrames);
+  std::swap(numChannels, other.numChannels);
+  planar.swap(other.planar);
+  planarFloat.swap(other.planarFloat);
+  channelStats.swap(other.channelStats);
+}
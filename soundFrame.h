@@ -0,0 +1,123 @@
+/** \file soundFrame.h
+ * One period of sound, split into separate channels once so that every
+ * processing stage can use it with unit stride.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+/*! A sound clip in planar (one array per channel) form, as both int16
+ *  and float, with the mean and standard deviation of each channel.
+ *
+ * Everything downstream wants one channel at a time, as float as well as
+ * int16, so each window is converted exactly once, in set(), and the
+ * SoundFrame is passed around instead of the raw samples. set() takes
+ * either interleaved samples, as ALSA delivers them, or channels that
+ * have already been split apart.
+ */
+class SoundFrame {
+ public:
+  /*! An empty frame. Call set() before using it. */
+  SoundFrame();
+  
+  /*! A frame with room for the given size, so set() won't allocate
+   *
+   * \param frames number of samples in each channel
+   * \param channels number of channels
+   */
+  SoundFrame(unsigned int frames, unsigned int channels);
+
+  /*! Convenience constructor: build a frame straight from a buffer
+   *
+   * \param buffer a sound clip, NUM_CHANNELS channels interleaved
+   */
+  explicit SoundFrame(const std::vector<int16_t>& buffer);
+
+  /*! Fill the frame from a new period of sound
+   *
+   * \param buffer a sound clip, interleaved
+   * \param channels number of channels interleaved in buffer
+   * \param removeDC if true, subtract each channel's mean from its
+   *        samples, as recenter does. stats() still reports the original
+   *        means.
+   */
+  void set(const std::vector<int16_t>& buffer, unsigned int channels,
+	   bool removeDC = false);
+
+  /*! Fill the frame from sound that is already one array per channel
+   *
+   * \param channels one pointer per channel, frames samples each
+   * \param frames number of samples in each channel
+   * \param channelCount number of channels
+   * \param removeDC as in the interleaved version
+   */
+  void set(const int16_t* const* channels, unsigned int frames,
+	   unsigned int channelCount, bool removeDC = false);
+
+  /*! Number of samples in each channel */
+  unsigned int frames() const { return numFrames; }
+  /*! Number of channels */
+  unsigned int channels() const { return numChannels; }
+
+  /*! Samples of one channel, frames() of them */
+  const int16_t* samples(unsigned int ch) const {
+    return planar.data() + ch*numFrames;
+  }
+  /*! Samples of one channel, converted to float, frames() of them */
+  const float* floats(unsigned int ch) const {
+    return planarFloat.data() + ch*numFrames;
+  }
+
+  /*! Mean (first) and standard deviation (second) of each channel, in
+   *  the same form as meansAndStdDevs returns them */
+  const std::vector<std::pair<float, float> >& stats() const {
+    return channelStats;
+  }
+
+  /*! Subtract a per channel offset from every sample, see recenter in
+   *  soundProcessing.h */
+  void subtractMeans(const std::vector<std::pair<float, float> >& istats);
+
+  /*! Trade contents with another frame, without copying */
+  void swap(SoundFrame& other);
+
+ private:
+  /*! Make room for a frame of the given size. Only allocates if the size
+   *  changed. */
+  void resize(unsigned int frames, unsigned int channels);
+  
+  unsigned int numFrames;
+  unsigned int numChannels;
+  /*! Channel ch occupies [ch*numFrames, (ch+1)*numFrames) */
+  std::vector<int16_t> planar;
+  /*! Same layout as planar */
+  std::vector<float> planarFloat;
+  std::vector<std::pair<float, float> > channelStats;
+};
@@ -28,100 +28,293 @@
 
 #include "soundProcessing.h"
 #include "constants.h"
+#include "xcorrKernels.h"
 #include <cmath> //For sqrt, abs, and so on
 #include <cstdint> //For int16_t
+#include <algorithm> //For min and max
 
 std::vector<std::pair<float, float> >
 meansAndStdDevs(const std::vector<int16_t>& buffer){
-  std::vector<float> total(NUM_CHANNELS, 0.0f);
-  std::vector<float> totalSq(NUM_CHANNELS, 0.0f);
-
-  std::vector<unsigned int> count(NUM_CHANNELS, 0);
-  //This assumes that the input format is S16_LE
-
-  int channel = 0;
-  for(int i = 0; i < buffer.size(); i++){
-    count[channel]++;
-    float val = (float)buffer[i];
-    total[channel] += val;
-    totalSq[channel] += val*val;
-    channel = (channel+1)%NUM_CHANNELS;
-  }
+  SoundFrame frame(buffer);
+  return frame.stats();
+}
 
-  std::vector<std::pair<float, float> > ret;
-  ret.resize(NUM_CHANNELS);
-  for(int i=0; i < NUM_CHANNELS; i++){
-    float avg = total[i]/count[i];
-    ret[i] = std::make_pair(avg, (float)sqrt(totalSq[i]/count[i] - avg*avg));
-  }
-  return ret;
+const std::vector<std::pair<float, float> >&
+meansAndStdDevs(const SoundFrame& frame){
+  return frame.stats();
 }
 
 float dotWithOffset(const std::vector<int16_t>& buffer,
 		     unsigned int ch1, unsigned int ch2,
 		     int offset){
-  unsigned int count = 0;
-  float total = 0.0f;
-  unsigned int frames = buffer.size() / NUM_CHANNELS;
-
-  int ch1offset = 0;
-  int ch2offset = 0;
-  if(offset >= 0){
-    ch2offset = offset;
-  } else {
-    ch1offset = -offset;
-  }
-  
-  for(int i=0; i < frames-std::abs(offset); i++){
-    count++;
-    
-    float val1 = (float)buffer[NUM_CHANNELS*(i+ch1offset)+ch1];
-    float val2 = (float)buffer[NUM_CHANNELS*(i+ch2offset)+ch2];
+  return dotWithOffset(SoundFrame(buffer), ch1, ch2, offset);
+}
 
-    total += val1*val2;
-  }
+float dotWithOffset(const SoundFrame& frame,
+		    unsigned int ch1, unsigned int ch2,
+		    int offset){
+  int64_t total;
+  xcorrSums(frame.samples(ch1), frame.samples(ch2), frame.frames(),
+	    offset, 1, &total);
+  unsigned int count = frame.frames() - std::abs(offset);
 
-  return total/count;
+  return (float)total/count;
 }
 
 std::vector<std::pair<float, float> >
 xcorr(const std::vector<int16_t>& buffer,
       unsigned int ch1, unsigned int ch2,
       int range){
-  std::vector<std::pair<float, float> > ret;
+  return xcorr(SoundFrame(buffer), ch1, ch2, range);
+}
+
+DspWorkspace::DspWorkspace(int maxRange) :
+  sums(2*maxRange + 1, 0), corrs(2*maxRange + 1, 0.0f) {
+}
+
+void xcorr(const SoundFrame& frame,
+	   unsigned int ch1, unsigned int ch2,
+	   int range, DspWorkspace& ws, float* out){
+  unsigned int numLags = 2*range + 1;
+  xcorrSums(frame.samples(ch1), frame.samples(ch2), frame.frames(),
+	    -range, numLags, ws.sums.data());
   
   for(int offset=-range; offset <= range; offset++){
-    ret.push_back(std::make_pair(offset, dotWithOffset(buffer, ch1, ch2,
-						       offset)));
+    unsigned int count = frame.frames() - std::abs(offset);
+    out[offset + range] = (float)ws.sums[offset + range]/count;
+  }
+}
+
+std::vector<std::pair<float, float> >
+xcorr(const SoundFrame& frame,
+      unsigned int ch1, unsigned int ch2,
+      int range){
+  DspWorkspace ws(range);
+  xcorr(frame, ch1, ch2, range, ws, ws.corrs.data());
+  
+  std::vector<std::pair<float, float> > ret;
+  ret.reserve(2*range + 1);
+  for(int offset=-range; offset <= range; offset++){
+    ret.push_back(std::make_pair(offset, ws.corrs[offset + range]));
   }
 
   return ret;
 }
 
+/*! Find the best lag in a correlation curve
+ *
+ * \param corrs 2*range+1 correlations, corrs[range+o] for offset o
+ * \param range range of the curve
+ * \return the lag and the correlation there. Ties go to the lag closest
+ *         to zero.
+ */
+static std::pair<int, float> peakOf(const float* corrs, int range){
+  int maxLag = -range;
+  float maxVal = corrs[0];
+  for(int lag=-range+1; lag <= range; lag++){
+    float val = corrs[lag + range];
+    if(val > maxVal ||
+       (val == maxVal && std::abs(lag) < std::abs(maxLag))){
+      maxVal = val;
+      maxLag = lag;
+    }
+  }
+  return std::make_pair(maxLag, maxVal);
+}
+
+/*! Position of the peak of a curve, refined to a fraction of a sample
+ *  unless it is at either end
+ *
+ * \param corrs the curve, corrs[range + o] is for offset o
+ * \param range the curve covers offsets -range to range
+ * \param lag whole number position of the peak, from peakOf
+ */
+static float refinePeak(const float* corrs, int range, int lag){
+  if(lag <= -range || lag >= range){
+    return (float)lag;
+  }
+  return lag + parabolicOffset(corrs[lag + range - 1], corrs[lag + range],
+			       corrs[lag + range + 1]);
+}
+
+float parabolicOffset(float left, float mid, float right){
+  float curvature = left - 2*mid + right;
+  //Written so that NaN gives 0 too
+  if(!(curvature < 0.0f)){
+    return 0.0f;
+  }
+  float offset = 0.5f*(left - right)/curvature;
+  return std::max(-0.5f, std::min(0.5f, offset));
+}
+
+unsigned int curvePeaks(const float* corrs, int range, int limit,
+			unsigned int k, bool subsample,
+			std::pair<float, float>* out){
+  unsigned int found = 0;
+  limit = std::min(limit, range);
+  for(int lag=-limit; lag <= limit; lag++){
+    float val = corrs[lag + range];
+    if((lag > -range && !(val > corrs[lag + range - 1])) ||
+       (lag < range && val < corrs[lag + range + 1])){
+      continue;
+    }
+    //Insertion into the short sorted list. Lags come in increasing
+    // order, so an equal value already there keeps its place.
+    unsigned int at = found;
+    while(at > 0 && out[at - 1].second < val){
+      at--;
+    }
+    if(at == k){
+      continue;
+    }
+    for(unsigned int i=std::min(found, k - 1); i > at; i--){
+      out[i] = out[i - 1];
+    }
+    out[at] = std::make_pair((float)lag, val);
+    found = std::min(found + 1, k);
+  }
+
+  if(subsample){
+    for(unsigned int i=0; i < found; i++){
+      out[i].first = refinePeak(corrs, range, (int)out[i].first);
+    }
+  }
+  return found;
+}
+
 std::pair<float, float> delay(const std::vector<int16_t>& buffer,
 			      unsigned int ch1, unsigned int ch2,
 			      int range){
-  std::vector<std::pair<float, float> > corrs
-    = xcorr(buffer, ch1, ch2, range+2); //TODO: Should this +2 be gone now?
+  return delay(SoundFrame(buffer), ch1, ch2, range);
+}
+
+std::pair<float, float> delay(const SoundFrame& frame,
+			      unsigned int ch1, unsigned int ch2,
+			      int range){
+  DspWorkspace ws(range+2);
+  return delay(frame, ch1, ch2, range, ws);
+}
 
-  float ac1 = dotWithOffset(buffer, ch1, ch1, 0);
-  float ac2 = dotWithOffset(buffer, ch2, ch2, 0);
+std::pair<float, float> delay(const SoundFrame& frame,
+			      unsigned int ch1, unsigned int ch2,
+			      int range, DspWorkspace& ws, bool subsample){
+  range += 2; //TODO: Should this +2 be gone now?
+  xcorr(frame, ch1, ch2, range, ws, ws.corrs.data());
   
-  int maxOffset = 0;
-  std::pair<float, float> maxVal = corrs[0];
+  float ac1 = dotWithOffset(frame, ch1, ch1, 0);
+  float ac2 = dotWithOffset(frame, ch2, ch2, 0);
+
+  std::pair<int, float> peak = peakOf(ws.corrs.data(), range);
+  float lag = subsample ? refinePeak(ws.corrs.data(), range, peak.first)
+    : (float)peak.first;
+  return std::make_pair(lag, peak.second/std::sqrt(ac1*ac2));
+}
+
+unsigned int pairIndex(unsigned int ch1, unsigned int ch2,
+		       unsigned int channels){
+  //Pairs starting with channel a come after all the pairs starting with
+  // a lower channel
+  return ch1*channels - ch1*(ch1 + 1)/2 + (ch2 - ch1 - 1);
+}
+
+PairCorrelations::PairCorrelations(int maxRange, unsigned int channels) :
+  channels(channels),
+  range(maxRange),
+  energy(channels, 0.0f),
+  curves(numPairs(channels)*(2*maxRange + 1), 0.0f),
+  sums(numPairs(channels)*(2*maxRange + 1), 0) {
+}
+
+std::pair<float, float> PairCorrelations::delay(unsigned int pair,
+						bool subsample) const {
+  unsigned int ch1 = 0;
+  while(pairIndex(ch1, channels - 1, channels) < pair) ch1++;
+  unsigned int ch2 = ch1 + 1 + (pair - pairIndex(ch1, ch1 + 1, channels));
+  
+  std::pair<int, float> peak = peakOf(curve(pair), range);
+  float lag = subsample ? refinePeak(curve(pair), range, peak.first)
+    : (float)peak.first;
+  return std::make_pair(lag,
+			peak.second/std::sqrt(energy[ch1]*energy[ch2]));
+}
+
+/*! Body of correlateAllPairs
+ *
+ * \tparam CHANNELS the channel count, if it is known at compile time, so
+ *         that every loop has a fixed trip count. 0 to use frame.channels()
+ *         instead.
+ */
+template <unsigned int CHANNELS>
+static void correlatePairs(const SoundFrame& frame, int range,
+			   PairCorrelations& out){
+  const unsigned int channels = CHANNELS ? CHANNELS : frame.channels();
+  const int16_t* ch[CHANNELS ? CHANNELS : MAX_CHANNELS];
+  for(unsigned int i=0; i < channels; i++){
+    ch[i] = frame.samples(i);
+  }
+
+  out.range = range;
+  unsigned int numLags = 2*range + 1;
+  if(CHANNELS == 4){
+    static_assert(numPairs(4) == NUM_FUSED_PAIRS,
+		  "fused kernel assumes four channels");
+    xcorrSumsAllPairs(ch, frame.frames(), -range, numLags, out.sums.data());
+  } else {
+    for(unsigned int a=0; a < channels; a++){
+      for(unsigned int b=a+1; b < channels; b++){
+	unsigned int p = pairIndex(a, b, channels);
+	xcorrSums(ch[a], ch[b], frame.frames(), -range, numLags,
+		  out.sums.data() + p*numLags);
+      }
+    }
+  }
   
-  for(int i=1; i<corrs.size(); i++){
-    if(corrs[i].second > maxVal.second){
-      maxVal = corrs[i];
-      maxOffset = i;
-    } else if(corrs[i].second == maxVal.second &&
-	      std::abs(corrs[i].first) < std::abs(maxVal.first)){
-      maxVal = corrs[i];
-      maxOffset = i;
+  int64_t squares[CHANNELS ? CHANNELS : MAX_CHANNELS];
+  for(unsigned int i=0; i < channels; i++){
+    xcorrSums(ch[i], ch[i], frame.frames(), 0, 1, &squares[i]);
+  }
+  normalizeCorrelations(frame.frames(), squares, out);
+}
+
+void normalizeCorrelations(unsigned int frames, const int64_t* squares,
+			   PairCorrelations& out){
+  const unsigned int pairs = numPairs(out.channels);
+  const int range = out.range;
+  const unsigned int numLags = 2*range + 1;
+  for(unsigned int p=0; p < pairs; p++){
+    for(int offset=-range; offset <= range; offset++){
+      unsigned int count = frames - std::abs(offset);
+      unsigned int i = p*numLags + offset + range;
+      out.curves[i] = (float)out.sums[i]/count;
     }
   }
 
-  return std::make_pair(maxVal.first, maxVal.second/std::sqrt(ac1*ac2));
+  for(unsigned int i=0; i < out.channels; i++){
+    out.energy[i] = (float)squares[i]/frames;
+  }
+}
+
+void normalizedCurves(const PairCorrelations& pairs, float* curves){
+  const unsigned int curveLen = 2*pairs.range + 1;
+  for(unsigned int i=0; i < pairs.channels; i++){
+    for(unsigned int j=i+1; j < pairs.channels; j++){
+      unsigned int p = pairIndex(i, j, pairs.channels);
+      float norm = std::sqrt(pairs.energy[i]*pairs.energy[j]);
+      const float* c = pairs.curve(p);
+      for(unsigned int k=0; k < curveLen; k++){
+	curves[p*curveLen + k] = norm > 0.0f ? c[k]/norm : 0.0f;
+      }
+    }
+  }
+}
+
+void correlateAllPairs(const SoundFrame& frame, int range,
+		       PairCorrelations& out){
+  if(frame.channels() == 4){
+    correlatePairs<4>(frame, range, out);
+  } else {
+    correlatePairs<0>(frame, range, out);
+  }
 }
 
 void recenter(std::vector<int16_t>& buffer, 
@@ -152,3 +345,8 @@ void recenter(std::vector<int16_t>& buffer,
     }
   }
 }
+
+void recenter(SoundFrame& frame,
+	      const std::vector<std::pair<float, float> >& stats){
+  frame.subtractMeans(stats);
+}
@@ -31,6 +31,18 @@
 #include <vector>
 #include <cstdint> //For int16_t
 
+#include "soundFrame.h"
+#include "constants.h"
+
+#include <array>
+
+/*
+ * Each function comes in two forms. The first takes an interleaved buffer
+ * straight from the microphone. The second takes a SoundFrame, which has
+ * already been split into channels; use that form when several functions
+ * are applied to the same clip, so the split only happens once.
+ */
+
 /*! Compute the mean and standard deviation of each channel of the sound
  *
  * \param buffer a buffer of sound data. Assumed to be 4 channels, interleaved
@@ -44,6 +56,11 @@
 std::vector<std::pair<float, float> >
 meansAndStdDevs(const std::vector<int16_t>& buffer);
 
+/*! Same as above, but the stats were already computed when the frame was
+ *  filled, so this is free */
+const std::vector<std::pair<float, float> >&
+meansAndStdDevs(const SoundFrame& frame);
+
 /*! Compute the normalized dot product of two channels of a sound, with an 
  *  optional 
  *  offset. Used in computing cross correlation (xcorr)
@@ -62,12 +79,21 @@ meansAndStdDevs(const std::vector<int16_t>& buffer);
  * \f$\frac{1}{n-o}\sum_{i=0}^{n-o-1} x_iy_{i+o}\f$. If offset is
  * negative, returns
  * \f$\frac{1}{n-o}\sum_{i=0}^{n-o-1} x_{i+o}y_{i}\f$
+ *
+ * \note The sum is computed exactly, in integers, by the vectorized
+ * kernels in xcorrKernels.h
  */
 float
 dotWithOffset(const std::vector<int16_t>& buffer,
 	      unsigned int ch1, unsigned int ch2,
 	      int offset);
 
+/*! Same as above, for a clip already split into channels */
+float
+dotWithOffset(const SoundFrame& frame,
+	      unsigned int ch1, unsigned int ch2,
+	      int offset);
+
 /*! Computes the similarity of two channels at various time shifts.
  *
  * \param buffer a sound clip, assumed to be 4 channels interleaved
@@ -85,6 +111,12 @@ xcorr(const std::vector<int16_t>& buffer,
       unsigned int ch1, unsigned int ch2,
       int range);
 
+/*! Same as above, for a clip already split into channels */
+std::vector<std::pair<float, float> >
+xcorr(const SoundFrame& frame,
+      unsigned int ch1, unsigned int ch2,
+      int range);
+
 /*! Estimates the delay between two signals based on the xcorr between them
  *
  * \param buffer a sound clip, assumed to be 4 channels interleaved
@@ -102,6 +134,189 @@ delay(const std::vector<int16_t>& buffer,
       unsigned int ch1, unsigned int ch2,
       int range);
 
+/*! Same as above, for a clip already split into channels */
+std::pair<float, float>
+delay(const SoundFrame& frame,
+      unsigned int ch1, unsigned int ch2,
+      int range);
+
+/*! Scratch memory for the allocation free versions of xcorr and delay.
+ *
+ * Make one up front and reuse it for every frame, so that the main loop
+ * never has to go to the heap.
+ */
+class DspWorkspace {
+ public:
+  /*! Allocate enough room for any range up to maxRange
+   *
+   * \param maxRange the largest range that will be passed to xcorr.
+   *        Note that delay(range) calls xcorr with range+2.
+   */
+  explicit DspWorkspace(int maxRange);
+
+  /*! Largest range this workspace can handle */
+  int maxRange() const { return (int)(sums.size()/2); }
+
+  /*! Raw correlation sums, one per lag */
+  std::vector<int64_t> sums;
+  /*! Normalized correlations, one per lag */
+  std::vector<float> corrs;
+};
+
+/*! Allocation free version of xcorr
+ *
+ * \param frame a sound clip, already split into channels
+ * \param ch1 which channel to use for first channel to compare
+ * \param ch2 which channel to use for second channel to compare
+ * \param range try all time lags between -range and range (inclusive).
+ *        Must be no more than ws.maxRange().
+ * \param ws scratch memory
+ * \param out receives 2*range+1 values. out[range+o] is the result of
+ *        dotWithOffset for offset o.
+ */
+void
+xcorr(const SoundFrame& frame,
+      unsigned int ch1, unsigned int ch2,
+      int range, DspWorkspace& ws, float* out);
+
+/*! Allocation free version of delay. Same arguments and results as delay,
+ *  plus scratch memory. range+2 must be no more than ws.maxRange().
+ *
+ *  If subsample is true, the delay is refined with parabolicOffset, so it
+ *  is no longer a whole number.
+ */
+std::pair<float, float>
+delay(const SoundFrame& frame,
+      unsigned int ch1, unsigned int ch2,
+      int range, DspWorkspace& ws, bool subsample = false);
+
+/*! Where the true peak of a correlation curve lies, between samples. Fits
+ *  a parabola through the largest value and its two neighbours.
+ *
+ * \param left value one lag before the peak
+ * \param mid value at the peak, which should be the largest of the three
+ * \param right value one lag after the peak
+ * \return offset of the top of the parabola from the peak, between -0.5
+ *         and 0.5. 0 if the three values don't have a maximum in the
+ *         middle.
+ */
+float parabolicOffset(float left, float mid, float right);
+
+/*! The highest few peaks of a correlation curve, rather than only the
+ *  highest point as in delay. A peak is a lag higher than the one before
+ *  it and no lower than the one after it; the ends count if they are
+ *  higher than their one neighbour.
+ *
+ * \param corrs the curve, corrs[range + o] is for offset o
+ * \param range the curve covers offsets -range to range
+ * \param limit only peaks with offsets from -limit to limit are kept
+ * \param k most peaks to return
+ * \param subsample refine each peak with parabolicOffset
+ * \param out receives up to k (lag, value) pairs, highest value first.
+ *        Ties go to the more negative lag.
+ * \return number of peaks found
+ */
+unsigned int curvePeaks(const float* corrs, int range, int limit,
+			unsigned int k, bool subsample,
+			std::pair<float, float>* out);
+
+/*! Number of distinct pairs among the given number of channels */
+constexpr unsigned int numPairs(unsigned int channels){
+  return channels*(channels - 1)/2;
+}
+
+/*! Number of distinct pairs of microphones in the default array */
+constexpr unsigned int NUM_PAIRS = numPairs(NUM_CHANNELS);
+
+/*! Index of the pair (ch1, ch2), ch1 < ch2, in PairCorrelations. Pairs are
+ *  ordered (0,1), (0,2), ..., (0,n-1), (1,2), ..., (n-2,n-1).
+ *
+ * \param ch1 first channel
+ * \param ch2 second channel, bigger than ch1
+ * \param channels number of channels in the clip
+ */
+unsigned int pairIndex(unsigned int ch1, unsigned int ch2,
+		       unsigned int channels = NUM_CHANNELS);
+
+/*! Cross correlation curves for every pair of channels, plus the energy of
+ *  each channel, as produced by correlateAllPairs. */
+class PairCorrelations {
+ public:
+  /*! Allocate room for curves up to the given range
+   *
+   * \param maxRange largest range that will be passed to correlateAllPairs
+   * \param channels number of channels in the frames that will be passed
+   *        to correlateAllPairs
+   */
+  explicit PairCorrelations(int maxRange,
+			    unsigned int channels = NUM_CHANNELS);
+
+  /*! Number of channels the curves are for */
+  unsigned int channels;
+
+  /*! Range of the curves: each has 2*range+1 lags, from -range to range */
+  int range;
+  
+  /*! Correlation curve of one pair, normalized as in dotWithOffset.
+   *  curve(p)[range + o] is for offset o. */
+  const float* curve(unsigned int pair) const {
+    return curves.data() + pair*(2*range + 1);
+  }
+
+  /*! Mean square of each channel, which is dotWithOffset(ch, ch, 0) */
+  std::vector<float> energy;
+
+  /*! Same result as delay(frame, ch1, ch2, range-2), using the curve of
+   *  the given pair
+   *
+   * \param pair index of the pair, from pairIndex
+   * \param subsample refine the delay with parabolicOffset
+   */
+  std::pair<float, float> delay(unsigned int pair,
+				bool subsample = false) const;
+  
+  /*! All the curves, one after the other */
+  std::vector<float> curves;
+  /*! Scratch space for the raw sums */
+  std::vector<int64_t> sums;
+};
+
+/*! Correlate every pair of channels in one fused pass, instead of a
+ *  separate xcorr for each pair. Does not allocate. The fused pass is
+ *  only for 4 channels; other channel counts correlate one pair at a time.
+ *
+ * \param frame a sound clip, already split into channels
+ * \param range compute lags from -range to range. Must be no more than
+ *        the maxRange out was made with. Note that to match delay(range),
+ *        this needs range+2.
+ * \param out receives the curves and energies. Must have been made for
+ *        frame.channels() channels.
+ */
+void correlateAllPairs(const SoundFrame& frame, int range,
+		       PairCorrelations& out);
+
+/*! Turn the raw sums in out.sums into out.curves and out.energy, the
+ *  last step of correlateAllPairs. For code that gets the sums some other
+ *  way, such as SlidingWindow.
+ *
+ * \param frames length of the clip the sums were taken over
+ * \param squares sum of the squares of each channel's samples
+ * \param out has sums for out.range filled in, for out.channels channels
+ */
+void normalizeCorrelations(unsigned int frames, const int64_t* squares,
+			   PairCorrelations& out);
+
+/*! Copy every pair's curve into curves, divided by the geometric mean of
+ *  the two channels' energies, so a perfect match peaks at 1 whatever the
+ *  loudness. This is the form SrpLocator and SourceAssociator take. A pair
+ *  with a silent channel gets a curve of zeros.
+ *
+ * \param pairs curves and energies from correlateAllPairs
+ * \param curves receives numPairs(pairs.channels) curves of 2*pairs.range+1
+ *        lags each, one after the other
+ */
+void normalizedCurves(const PairCorrelations& pairs, float* curves);
+
 /*! For each channel, shift it up or down so the mean becomes zero.
  *
  * \param buffer a sound clip, assumed to be 4 channels interleaved
@@ -111,3 +326,8 @@ delay(const std::vector<int16_t>& buffer,
 void
 recenter(std::vector<int16_t>& buffer,
 	 std::vector<std::pair<float, float> > stats);
+
+/*! Same as above, for a clip already split into channels */
+void
+recenter(SoundFrame& frame,
+	 const std::vector<std::pair<float, float> >& stats);
@@ -0,0 +1,185 @@
+/** \file sourceAssociation.cpp
+ * Directions for several sounds at once, from the top few peaks of every
+ * pair's correlation curve.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include "sourceAssociation.h"
+
+#include <cmath>
+#include <string>
+#include <algorithm>
+
+#include "geometry.h"
+#include "soundProcessing.h"
+#include "utils.h"
+
+SourceAssociator::SourceAssociator(unsigned int sources, int range) :
+  sources(sources), mics(MIC_LOCATIONS.size()), range(range) {
+  if(sources < 1 || sources > MAX_SOURCES){
+    throw std::string("can only look for 1 to ")
+      + std::to_string(MAX_SOURCES) + " sounds at once";
+  }
+
+  limits.resize(numPairs(mics));
+  for(unsigned int i=0; i < mics; i++){
+    for(unsigned int j=i+1; j < mics; j++){
+      float d = dist(MIC_LOCATIONS[i], MIC_LOCATIONS[j]);
+      limits[pairIndex(i, j, mics)] =
+	(int)std::ceil(d*SPEED_OF_SOUND_SAMPLES_PER_METER) + 1;
+    }
+  }
+
+  peaks.resize((mics - 1)*PEAKS_PER_PAIR);
+  peakCounts.resize(mics - 1);
+  beam.assign(ASSOCIATION_BEAM, Hypothesis{std::vector<float>(mics - 1),
+					   0.0f, 0.0f});
+  next = beam;
+  found.assign(sources, std::vector<float>(numPairs(mics), 0.0f));
+  strengths.assign(sources, 0.0f);
+  weakest.assign(sources, 0.0f);
+  taken.assign(ASSOCIATION_BEAM, 0);
+}
+
+float SourceAssociator::curveAt(const float* curves, unsigned int pair,
+				float lag) const {
+  if(std::fabs(lag) > limits[pair] || std::fabs(lag) > range){
+    return -1.0f;
+  }
+  const float* c = curves + pair*(2*range + 1) + range;
+  int lo = (int)std::floor(lag);
+  float frac = lag - lo;
+  if(frac == 0.0f || lo + 1 > range){
+    return c[lo];
+  }
+  return (1.0f - frac)*c[lo] + frac*c[lo + 1];
+}
+
+unsigned int SourceAssociator::associate(const float* curves,
+					 bool subsample){
+  //Candidate delays against mic 0 come from the peaks of those pairs.
+  // Pair (0, j) peaks at lag t_j - t_0.
+  for(unsigned int j=1; j < mics; j++){
+    unsigned int p = pairIndex(0, j, mics);
+    peakCounts[j-1] = curvePeaks(curves + p*(2*range + 1), range, limits[p],
+				 PEAKS_PER_PAIR, subsample,
+				 peaks.data() + (j-1)*PEAKS_PER_PAIR);
+  }
+
+  //Choose t_0 - t_j one mic at a time. Each choice scores its own peak,
+  // plus every pair it closes with the mics already chosen.
+  unsigned int beamSize = 1;
+  beam[0].score = 0.0f;
+  beam[0].weakest = 1.0f;
+  for(unsigned int j=1; j < mics; j++){
+    unsigned int nextSize = 0;
+    for(unsigned int b=0; b < beamSize; b++){
+      Hypothesis& h = beam[b];
+      for(unsigned int q=0; q < peakCounts[j-1]; q++){
+	const std::pair<float, float>& peak = peaks[(j-1)*PEAKS_PER_PAIR + q];
+	float arrival = -peak.first;
+	float score = h.score + peak.second;
+	float weakest = std::min(h.weakest, peak.second);
+	for(unsigned int i=1; i < j; i++){
+	  float val = curveAt(curves, pairIndex(i, j, mics),
+			      h.arrival[i-1] - arrival);
+	  score += val;
+	  weakest = std::min(weakest, val);
+	}
+
+	//Insert into next, kept sorted best first
+	unsigned int at = nextSize;
+	while(at > 0 && next[at - 1].score < score){
+	  at--;
+	}
+	if(at == ASSOCIATION_BEAM){
+	  continue;
+	}
+	nextSize = std::min(nextSize + 1, ASSOCIATION_BEAM);
+	for(unsigned int n=nextSize - 1; n > at; n--){
+	  std::swap(next[n], next[n - 1]);
+	}
+	std::copy(h.arrival.begin(), h.arrival.begin() + (j-1),
+		  next[at].arrival.begin());
+	next[at].arrival[j-1] = arrival;
+	next[at].score = score;
+	next[at].weakest = weakest;
+      }
+    }
+    beam.swap(next);
+    beamSize = nextSize;
+  }
+
+  //A real sound peaks on every pair. A combination that is a real sound
+  // on most pairs and a side lobe on the rest still scores well in total,
+  // so the sounds are picked by their weakest pair instead.
+  unsigned int count = 0;
+  std::fill(taken.begin(), taken.end(), 0);
+  while(count < sources){
+    int pick = -1;
+    for(unsigned int b=0; b < beamSize; b++){
+      if(!taken[b] && (pick < 0 || beam[b].weakest > beam[pick].weakest)){
+	pick = b;
+      }
+    }
+    if(pick < 0){
+      break;
+    }
+    taken[pick] = 1;
+    const Hypothesis& h = beam[pick];
+    if(!(h.weakest > 0.0f) ||
+       (count > 0 && h.weakest < MIN_SOURCE_RATIO*weakest[0])){
+      break;
+    }
+
+    //Skip the same sound, with a slightly different peak on some pair
+    bool repeat = false;
+    for(unsigned int s=0; s < count && !repeat; s++){
+      repeat = true;
+      for(unsigned int j=1; j < mics; j++){
+	if(std::fabs(found[s][pairIndex(0, j, mics)] - h.arrival[j-1])
+	   > SAME_SOURCE_SAMPLES){
+	  repeat = false;
+	  break;
+	}
+      }
+    }
+    if(repeat){
+      continue;
+    }
+
+    for(unsigned int i=0; i < mics; i++){
+      for(unsigned int j=i+1; j < mics; j++){
+	float ti = i == 0 ? 0.0f : h.arrival[i-1];
+	found[count][pairIndex(i, j, mics)] = h.arrival[j-1] - ti;
+      }
+    }
+    strengths[count] = h.score/numPairs(mics);
+    weakest[count] = h.weakest;
+    count++;
+  }
+  return count;
+}
@@ -0,0 +1,155 @@
+/** \file sourceAssociation.h
+ * Directions for several sounds at once, from the top few peaks of every
+ * pair's correlation curve.
+ *
+ * With two sounds at once each pair's curve has two peaks, and taking
+ * only the highest of each mixes them: one pair's highest peak may come
+ * from one sound and the next pair's from the other. The delays of a
+ * single sound have to agree with each other, though. With t_i the time
+ * the sound reaches mic i, pair (i, j) must peak at t_j - t_i, which is
+ * (t_j - t_0) - (t_i - t_0). So the delays against mic 0 are taken from
+ * the peaks of those pairs, one combination at a time, and each
+ * combination is scored by how high every pair's curve is at the delays
+ * it implies. A real sound is high on every pair, so the combinations
+ * whose weakest pair is highest, and that are not the same sound twice,
+ * are the sounds.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#pragma once
+
+#include <vector>
+#include <utility>
+
+#include "constants.h"
+
+/*! Most sounds that can be reported for one window */
+constexpr unsigned int MAX_SOURCES = 4;
+
+/*! Peaks kept from each pair's curve. One more than the sounds looked
+ *  for, since echoes make peaks too. */
+constexpr unsigned int PEAKS_PER_PAIR = MAX_SOURCES + 1;
+
+/*! Number of combinations of peaks on the pairs against mic 0 for an
+ *  array of the given size, PEAKS_PER_PAIR^(mics - 1) */
+constexpr unsigned int peakCombinations(unsigned int mics){
+  return mics <= 1 ? 1 : PEAKS_PER_PAIR*peakCombinations(mics - 1);
+}
+
+/*! Partial combinations kept while the delays against mic 0 are chosen
+ *  one mic at a time. This is every combination for the default array,
+ *  125 for 4 mics, so there the sounds are picked by their weakest pair
+ *  from all of them. With more mics the partial combinations with the
+ *  lowest total score are dropped after each mic. A real sound peaks on
+ *  every pair closed so far, so its total stays near the top, and what
+ *  goes are combinations with side lobes or another sound's peaks on
+ *  several pairs. */
+constexpr unsigned int ASSOCIATION_BEAM = peakCombinations(NUM_CHANNELS);
+
+/*! A sound is only reported if its weakest pair scores at least this
+ *  fraction of the weakest pair of the best sound in the same window */
+constexpr float MIN_SOURCE_RATIO = 0.3f;
+
+/*! Two combinations whose delays against mic 0 are all within this many
+ *  samples of each other are the same sound */
+constexpr float SAME_SOURCE_SAMPLES = 1.5f;
+
+/*! Splits the pair correlation curves of one window into the delays of
+ *  up to a fixed number of separate sounds, for the microphones in
+ *  MIC_LOCATIONS.
+ *
+ * Usage: call associate once per window, then offsets for each sound it
+ * found. Nothing is allocated after construction.
+ */
+class SourceAssociator {
+ public:
+  /*! Allocate everything needed
+   *
+   * \param sources most sounds to report, from 1 to MAX_SOURCES
+   * \param range range of the curves that will be passed to associate:
+   *        each has 2*range+1 lags, from -range to range
+   */
+  SourceAssociator(unsigned int sources, int range);
+
+  /*! Find the sounds in one window
+   *
+   * \param curves one curve per pair, in pairIndex order, one after the
+   *        other, normalized so that a perfect match is 1.0, as for
+   *        SrpLocator::locate
+   * \param subsample refine peaks with parabolicOffset
+   * \return number of sounds found, best first. 0 if nothing stood out.
+   */
+  unsigned int associate(const float* curves, bool subsample);
+
+  /*! Delays of one sound, as offsets[pairIndex(i, j)]: t_i - t_j in
+   *  samples, how much later the sound reached mic i than mic j
+   *
+   * \param source index of the sound, less than the last result of
+   *        associate
+   */
+  const std::vector<float>& offsets(unsigned int source) const {
+    return found[source];
+  }
+
+  /*! Score of one sound: the mean over all pairs of the curve at its
+   *  delays */
+  float strength(unsigned int source) const {
+    return strengths[source];
+  }
+
+ private:
+  /*! A choice of t_0 - t_j for mics 1 to some j, the sum of the curves
+   *  at the delays it implies so far, and the lowest of them */
+  struct Hypothesis {
+    std::vector<float> arrival;
+    float score;
+    float weakest;
+  };
+
+  /*! Curve of a pair at a lag that may fall between samples, or -1 if
+   *  the lag is off the end of the curve */
+  float curveAt(const float* curves, unsigned int pair, float lag) const;
+
+  unsigned int sources;
+  unsigned int mics;
+  int range;
+  /*! Longest delay each pair could physically have, plus a sample */
+  std::vector<int> limits;
+  
+  /*! Peaks of the pairs against mic 0, PEAKS_PER_PAIR per pair */
+  std::vector<std::pair<float, float> > peaks;
+  std::vector<unsigned int> peakCounts;
+  /*! Beam of partial combinations, and the next one being built */
+  std::vector<Hypothesis> beam;
+  std::vector<Hypothesis> next;
+  /*! Results of the last call to associate */
+  std::vector<std::vector<float> > found;
+  std::vector<float> strengths;
+  /*! Lowest pair score of each sound found */
+  std::vector<float> weakest;
+  /*! Which of the beam have been considered, while picking sounds */
+  std::vector<char> taken;
+};
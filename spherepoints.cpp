@@ -30,54 +30,241 @@
 
 #include "spherepoints.h"
 #include <cmath>
+#include <unordered_map>
+#include <string>
 
-std::vector<std::vector<float> > genPoints(int n){
-  std::vector<std::vector<float> > pts;
+std::vector<Vec3> genPoints(int n){
+  std::vector<Vec3> pts;
+  pts.reserve(std::max(n, 0));
 
   float golden_angle = 3.14159265359 * (3 - std::sqrt(5));
   for(int i=0; i < n; i++){
     float theta = i*golden_angle;
     float z = (1 - 1/(float)n)*(1 - (2*i)/(float)(n-1));
     float r = std::sqrt(1 - z*z);
-    std::vector<float> pt = {r*std::cos(theta), r*std::sin(theta), z};
-    pts.push_back(pt);
+    pts.push_back({r*std::cos(theta), r*std::sin(theta), z});
   }
 
   return pts;
 }
 
-/*! For testing purposes, measure the angle between each point and its
- * nearest neighbor, and return the largest such angle found.
- */
-float maxMinAngle(std::vector<std::vector<float> >& pts){
-  float max = 0.0f;
-  for(int i=0; i<pts.size(); i++){
-    float min = 10000000.0f;
-    for(int j=0; j<pts.size(); j++){
-      if(j == i) continue;
-      //Calculate the angle between the two points, through the origin
-      float dotProd = 0;
-      for(int k=0; k<3; k++){
-	dotProd += pts[i][k]*pts[j][k];
+/*! Cell of the spatial hash a coordinate falls in */
+static int64_t hashCell(float x, float cellSize){
+  return (int64_t)std::floor(x/cellSize);
+}
+
+/*! Key of a cell, unique for any cell of a sphere of radius 1 or less.
+ *  Keys sort by x, then y, then z. */
+static int64_t hashKey(int64_t x, int64_t y, int64_t z){
+  constexpr int64_t SPAN = 1 << 20;
+  return ((x + SPAN/2)*SPAN + (y + SPAN/2))*SPAN + (z + SPAN/2);
+}
+
+SpacingStats pointSpacing(const std::vector<Vec3>& points,
+			  unsigned int bins){
+  SpacingStats ret = {0.0f, 0.0f, 0.0f, std::vector<unsigned int>(bins, 0)};
+  if(points.size() < 2){
+    return ret;
+  }
+
+  //The cells and the distance to angle conversion below only work on the
+  // unit sphere
+  std::vector<Vec3> pts(points.size());
+  for(unsigned int i=0; i < points.size(); i++){
+    const Vec3& p = points[i];
+    float len = std::sqrt(p[0]*p[0] + p[1]*p[1] + p[2]*p[2]);
+    if(!(len > 0.0f)){
+      throw std::string("pointSpacing: point ") + std::to_string(i)
+	+ " has no direction";
+    }
+    pts[i] = Vec3{p[0]/len, p[1]/len, p[2]/len};
+  }
+  
+  //Cells about twice as wide as the typical spacing of n points on a
+  // unit sphere, so the 27 cells around a point nearly always hold its
+  // nearest neighbour, and are close enough to prove it
+  float cellSize = 2*std::sqrt(4*3.14159265359f/pts.size());
+  std::vector<std::pair<int64_t, unsigned int> > sorted(pts.size());
+  for(unsigned int i=0; i < pts.size(); i++){
+    sorted[i] = std::make_pair(hashKey(hashCell(pts[i][0], cellSize),
+				       hashCell(pts[i][1], cellSize),
+				       hashCell(pts[i][2], cellSize)), i);
+  }
+  std::sort(sorted.begin(), sorted.end());
+  std::vector<int64_t> keys(sorted.size());
+  for(unsigned int i=0; i < sorted.size(); i++){
+    keys[i] = sorted[i].first;
+  }
+
+  //Closest other point to each point, as a straight line distance. After
+  // every cell within ring r of a point's cell has been checked, anything
+  // not yet seen is at least r cells away. Points are visited in cell
+  // order, so their neighbours are mostly still in the cache.
+  std::vector<float> nearest(pts.size());
+  for(const std::pair<int64_t, unsigned int>& entry : sorted){
+    unsigned int i = entry.second;
+    int64_t cx = hashCell(pts[i][0], cellSize);
+    int64_t cy = hashCell(pts[i][1], cellSize);
+    int64_t cz = hashCell(pts[i][2], cellSize);
+    float best = 4.0f;
+    for(int64_t ring=1; best > (ring - 1)*cellSize; ring++){
+      for(int64_t x=cx-ring; x <= cx+ring; x++){
+	for(int64_t y=cy-ring; y <= cy+ring; y++){
+	  //Each column of cells is one run of keys. Inside the shell only
+	  // its two end cells are new on this ring.
+	  bool inside = ring > 1 && std::abs(x - cx) < ring
+	    && std::abs(y - cy) < ring;
+	  int64_t last = hashKey(x, y, cz + ring);
+	  for(auto k = std::lower_bound(keys.begin(), keys.end(),
+					hashKey(x, y, cz - ring));
+	      k != keys.end() && *k <= last; ++k){
+	    if(inside && *k != last && *k != hashKey(x, y, cz - ring)){
+	      continue;
+	    }
+	    unsigned int j = sorted[k - keys.begin()].second;
+	    if(j == i) continue;
+	    float d = dist(pts[i], pts[j]);
+	    if(d < best){
+	      best = d;
+	    }
+	  }
+	}
       }
-      float len1 = 0;
-      float len2 = 0;
-      for(int k=0; k<3; k++){
-	len1 += pts[i][k]*pts[i][k];
-	len2 += pts[j][k]*pts[j][k];
+    }
+    nearest[i] = best;
+  }
+
+  //Angles through the origin, from the straight line distances
+  double total = 0.0;
+  ret.minAngle = 10.0f;
+  for(float& n : nearest){
+    n = 2*std::asin(std::min(1.0f, n/2));
+    ret.minAngle = std::min(ret.minAngle, n);
+    ret.maxAngle = std::max(ret.maxAngle, n);
+    total += n;
+  }
+  ret.meanAngle = total/nearest.size();
+
+  float width = (ret.maxAngle - ret.minAngle)/std::max(1u, bins);
+  for(float n : nearest){
+    if(bins == 0) break;
+    unsigned int bin = width > 0.0f ? (n - ret.minAngle)/width : 0;
+    ret.histogram[std::min(bin, bins - 1)]++;
+  }
+
+  return ret;
+}
+
+float maxMinAngle(const std::vector<Vec3>& pts){
+  return pointSpacing(pts, 0).maxAngle;
+}
+
+/*! Neighbour lists of every point, from a list of triangles */
+static void linkTriangles(const std::vector<std::array<uint32_t, 3> >& tris,
+			  unsigned int numPoints,
+			  std::vector<uint32_t>& offsets,
+			  std::vector<uint32_t>& links){
+  std::vector<std::vector<uint32_t> > adj(numPoints);
+  for(const std::array<uint32_t, 3>& t : tris){
+    for(int e=0; e<3; e++){
+      adj[t[e]].push_back(t[(e+1)%3]);
+      adj[t[(e+1)%3]].push_back(t[e]);
+    }
+  }
+
+  offsets.assign(1, 0);
+  links.clear();
+  for(std::vector<uint32_t>& a : adj){
+    std::sort(a.begin(), a.end());
+    a.erase(std::unique(a.begin(), a.end()), a.end());
+    links.insert(links.end(), a.begin(), a.end());
+    offsets.push_back(links.size());
+  }
+}
+
+SphereGrid::SphereGrid(unsigned int finest) : stamp(0), evaluated(0) {
+  //The corners of an icosahedron are the cyclic permutations of
+  // (0, +-1, +-phi). Corners 2 apart share an edge.
+  float phi = (1 + std::sqrt(5.0f))/2;
+  for(int axis=0; axis<3; axis++){
+    for(float a : {-1.0f, 1.0f}){
+      for(float b : {-phi, phi}){
+	Vec3 v;
+	v[axis] = 0.0f;
+	v[(axis+1)%3] = a;
+	v[(axis+2)%3] = b;
+	pts.push_back(v);
       }
-      len1 = std::sqrt(len1);
-      len2 = std::sqrt(len2);
-      float cosTheta = dotProd/(len1*len2);
-      float theta = std::acos(cosTheta);
-      if(theta < min){
-	min = theta;
+    }
+  }
+  std::vector<std::array<uint32_t, 3> > tris;
+  auto edge = [this](uint32_t i, uint32_t j){
+    return std::fabs(dist(pts[i], pts[j]) - 2.0f) < 0.01f;
+  };
+  for(uint32_t i=0; i < pts.size(); i++){
+    for(uint32_t j=i+1; j < pts.size(); j++){
+      for(uint32_t k=j+1; k < pts.size(); k++){
+	if(edge(i, j) && edge(j, k) && edge(i, k)){
+	  tris.push_back({i, j, k});
+	}
       }
     }
-    if(min > max){
-      max = min;
+  }
+  for(Vec3& v : pts){
+    float len = std::sqrt(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+    v = {v[0]/len, v[1]/len, v[2]/len};
+  }
+
+  offsets.resize(finest + 1);
+  links.resize(finest + 1);
+  linkTriangles(tris, pts.size(), offsets[0], links[0]);
+  for(unsigned int level=1; level <= finest; level++){
+    //Each edge is shared by two triangles, but gets one new point
+    std::unordered_map<uint64_t, uint32_t> split;
+    auto middle = [this, &split](uint32_t a, uint32_t b){
+      uint64_t key = ((uint64_t)std::min(a, b) << 32) | std::max(a, b);
+      auto found = split.find(key);
+      if(found != split.end()){
+	return found->second;
+      }
+      Vec3 m = {pts[a][0] + pts[b][0], pts[a][1] + pts[b][1],
+		pts[a][2] + pts[b][2]};
+      float len = std::sqrt(m[0]*m[0] + m[1]*m[1] + m[2]*m[2]);
+      pts.push_back({m[0]/len, m[1]/len, m[2]/len});
+      split[key] = pts.size() - 1;
+      return (uint32_t)(pts.size() - 1);
+    };
+
+    std::vector<std::array<uint32_t, 3> > finer;
+    for(const std::array<uint32_t, 3>& t : tris){
+      uint32_t ab = middle(t[0], t[1]);
+      uint32_t bc = middle(t[1], t[2]);
+      uint32_t ca = middle(t[2], t[0]);
+      finer.push_back({t[0], ab, ca});
+      finer.push_back({t[1], bc, ab});
+      finer.push_back({t[2], ca, bc});
+      finer.push_back({ab, bc, ca});
     }
+    tris.swap(finer);
+    linkTriangles(tris, pts.size(), offsets[level], links[level]);
   }
 
-  return max;
+  marks.assign(pts.size(), 0);
+  kept.reserve(SPHERE_SEARCH_MAX_BEAM + 1);
+  previous.reserve(SPHERE_SEARCH_MAX_BEAM);
+}
+
+void SphereGrid::keep(unsigned int i, float s, unsigned int beam){
+  //Ties go to the point scored first
+  if(kept.size() == beam && !(s > kept.back().first)){
+    return;
+  }
+  auto at = kept.begin();
+  while(at != kept.end() && at->first >= s){
+    ++at;
+  }
+  kept.insert(at, std::make_pair(s, i));
+  if(kept.size() > beam){
+    kept.pop_back();
+  }
 }
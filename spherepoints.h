@@ -1,5 +1,7 @@
 /** \file spherepoints.h
- * Generate n points on a sphere that are close to evenly spaced
+ * Generate n points on a sphere that are close to evenly spaced, either
+ * as a flat list or as a grid of nested levels for coarse to fine
+ * searches.
  *
  * \note Uses the method of http://blog.marmakoide.org/?p=1
  *
@@ -31,10 +33,180 @@
 #pragma once
 
 #include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "utils.h"
 
 /*! Create a list of n 3D vectors that are roughly evenly spaced
  * on a unit sphere. Uses the method of http://blog.marmakoide.org/?p=1 
  *
  * \param n number of points desired
  */
-std::vector<std::vector<float> > genPoints(int n);
+std::vector<Vec3> genPoints(int n);
+
+/*! How far each point of a set is from its nearest neighbour, as angles
+ *  through the origin, in radians */
+struct SpacingStats {
+  float minAngle;
+  float maxAngle;
+  float meanAngle;
+  /*! Number of points whose nearest neighbour angle falls in each of
+   *  equal width bins from minAngle to maxAngle */
+  std::vector<unsigned int> histogram;
+};
+
+/*! For testing a point set, such as the output of genPoints: the angle
+ *  between each point and its nearest neighbour. The points are bucketed
+ *  in a spatial hash, so each one is only compared to those nearby, and
+ *  the whole check is O(n log n). The 64k points buildLUT uses take about
+ *  50 ms, where comparing every pair takes about 8 s.
+ *
+ * \param pts the points. Only their directions matter: each is scaled to
+ *        unit length before they are compared.
+ * \param bins number of histogram bins
+ */
+SpacingStats pointSpacing(const std::vector<Vec3>& pts,
+			  unsigned int bins = 10);
+
+/*! The largest angle between a point and its nearest neighbour, from
+ *  pointSpacing, so the points need not be unit length */
+float maxMinAngle(const std::vector<Vec3>& pts);
+
+/*! Points on a unit sphere in nested levels of detail, with links between
+ *  neighbours.
+ *
+ * Level 0 is the 12 corners of an icosahedron. Each level splits every
+ * triangle of the one before into 4, adding a point in the middle of each
+ * edge, pushed out onto the sphere. Level l has 10*4^l + 2 points, about
+ * 63/2^l degrees apart, and they are the first points of level l+1, so a
+ * point keeps its index at every finer level. Its neighbours at level l+1
+ * are the points that split its edges, which is what makes it cheap to
+ * zoom in on a good point.
+ */
+class SphereGrid {
+ public:
+  /*! Build every level up to and including finest
+   *
+   * \param finest index of the finest level. Level 6, about 1 degree
+   *        between neighbours, has 40962 points.
+   */
+  explicit SphereGrid(unsigned int finest);
+
+  /*! Index of the finest level */
+  unsigned int finest() const {
+    return offsets.size() - 1;
+  }
+
+  /*! Number of points in a level. They are points()[0] to
+   *  points()[size(level) - 1]. */
+  static unsigned int size(unsigned int level){
+    return 10*(1u << 2*level) + 2;
+  }
+
+  /*! Every point of the finest level, as unit vectors */
+  const std::vector<Vec3>& points() const {
+    return pts;
+  }
+
+  /*! Neighbours of a point at one level
+   *
+   * \param level level to take the neighbours from. The point must be in
+   *        it, or in a coarser one.
+   * \param i index of the point
+   * \param count receives the number of neighbours, 5 or 6
+   * \return indexes of the neighbours
+   */
+  const uint32_t* neighbours(unsigned int level, unsigned int i,
+			     unsigned int& count) const {
+    const std::vector<uint32_t>& off = offsets[level];
+    count = off[i + 1] - off[i];
+    return links[level].data() + off[i];
+  }
+
+  /*! Coarse to fine search for the point with the highest score.
+   *
+   * Every point of startLevel is scored. At each finer level, only the
+   * best few points so far and their neighbours at that level are scored,
+   * so reaching level 6 from level 2 costs a few hundred calls to score,
+   * not 40962. The score should change smoothly across the sphere for
+   * this to find the true best point.
+   *
+   * \param score called as score(i) for the index of a point, returns a
+   *        float, larger is better
+   * \param startLevel level that is scored exhaustively
+   * \param beam how many of the best points are refined at each level,
+   *        at most SPHERE_SEARCH_MAX_BEAM
+   * \param best receives the score of the point returned
+   * \return index of the best point found, at the finest level
+   */
+  template<typename Score>
+  unsigned int search(Score score, unsigned int startLevel, unsigned int beam,
+		      float& best);
+
+  /*! Number of calls to score made by the last search */
+  unsigned int evaluations() const {
+    return evaluated;
+  }
+  
+ private:
+  /*! Keep the best beam points in kept, sorted best first */
+  void keep(unsigned int i, float s, unsigned int beam);
+  
+  std::vector<Vec3> pts;
+  /*! Neighbours of point i at level l are links[l][offsets[l][i]] to
+   *  links[l][offsets[l][i+1] - 1] */
+  std::vector<std::vector<uint32_t> > offsets;
+  std::vector<std::vector<uint32_t> > links;
+
+  /*! Scratch for search: marks[i] == stamp if i has been scored in the
+   *  current search */
+  std::vector<uint32_t> marks;
+  uint32_t stamp;
+  unsigned int evaluated;
+  /*! Best points so far, and their scores */
+  std::vector<std::pair<float, unsigned int> > kept;
+  std::vector<std::pair<float, unsigned int> > previous;
+};
+
+/*! Widest beam SphereGrid::search supports */
+constexpr unsigned int SPHERE_SEARCH_MAX_BEAM = 16;
+
+template<typename Score>
+unsigned int SphereGrid::search(Score score, unsigned int startLevel,
+				unsigned int beam, float& best){
+  beam = std::max(1u, std::min(beam, SPHERE_SEARCH_MAX_BEAM));
+  startLevel = std::min(startLevel, finest());
+  if(++stamp == 0){
+    std::fill(marks.begin(), marks.end(), 0);
+    stamp = 1;
+  }
+  evaluated = 0;
+  
+  kept.clear();
+  for(unsigned int i=0; i < size(startLevel); i++){
+    marks[i] = stamp;
+    keep(i, score(i), beam);
+  }
+  evaluated = size(startLevel);
+
+  for(unsigned int level=startLevel + 1; level <= finest(); level++){
+    //The points kept so far stay in the running without being scored
+    // again
+    previous.assign(kept.begin(), kept.end());
+    for(const std::pair<float, unsigned int>& k : previous){
+      unsigned int count;
+      const uint32_t* n = neighbours(level, k.second, count);
+      for(unsigned int c=0; c < count; c++){
+	if(marks[n[c]] != stamp){
+	  marks[n[c]] = stamp;
+	  keep(n[c], score(n[c]), beam);
+	  evaluated++;
+	}
+      }
+    }
+  }
+
+  best = kept[0].first;
+  return kept[0].second;
+}
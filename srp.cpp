@@ -0,0 +1,235 @@
+/** \file srp.cpp
+ * Steered response power: direction of a sound straight from the pair
+ * correlation curves.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include "srp.h"
+
+#include <cmath>
+#include <string>
+#include <algorithm>
+#include <cstring>
+
+#include "geometry.h"
+#include "soundProcessing.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SRP_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SRP_NEON
+#include <arm_neon.h>
+#endif
+
+/*! Number of directions each pass of a scoring kernel handles */
+constexpr unsigned int SRP_BLOCK = 8;
+
+/*! Signature of a kernel that scores directions [0, n), n a multiple of
+ *  SRP_BLOCK. scores[d] is the sum over pairs p of
+ *  curves[index[p*stride + d]], added up in pair order. */
+typedef void (*ScoreKernel)(const float* curves, const int32_t* index,
+			    unsigned int pairs, unsigned int stride,
+			    unsigned int n, float* scores);
+
+static void scoreScalar(const float* curves, const int32_t* index,
+			unsigned int pairs, unsigned int stride,
+			unsigned int n, float* scores){
+  for(unsigned int d=0; d < n; d++){
+    float total = 0.0f;
+    for(unsigned int p=0; p < pairs; p++){
+      total += curves[index[p*stride + d]];
+    }
+    scores[d] = total;
+  }
+}
+
+#ifdef SRP_X86
+/*! Eight directions per pass, one gather per pair. The additions happen
+ *  in the same order as scoreScalar, so the scores match it exactly. */
+__attribute__((target("avx2")))
+static void scoreAVX2(const float* curves, const int32_t* index,
+		      unsigned int pairs, unsigned int stride,
+		      unsigned int n, float* scores){
+  for(unsigned int d=0; d < n; d += SRP_BLOCK){
+    __m256 total = _mm256_setzero_ps();
+    for(unsigned int p=0; p < pairs; p++){
+      __m256i idx = _mm256_loadu_si256((const __m256i*)(index + p*stride + d));
+      total = _mm256_add_ps(total, _mm256_i32gather_ps(curves, idx, 4));
+    }
+    _mm256_storeu_ps(scores + d, total);
+  }
+}
+#endif
+
+#ifdef SRP_NEON
+/*! The curve values of four directions for one pair, one lane at a time,
+ *  since NEON has no gather */
+static inline float32x4_t gatherNEON(const float* curves,
+				     const int32_t* index){
+  float32x4_t v = vld1q_dup_f32(curves + index[0]);
+  v = vld1q_lane_f32(curves + index[1], v, 1);
+  v = vld1q_lane_f32(curves + index[2], v, 2);
+  v = vld1q_lane_f32(curves + index[3], v, 3);
+  return v;
+}
+
+/*! Eight directions per pass, as two vectors of four. Like scoreAVX2 the
+ *  additions happen in pair order, so the scores match scoreScalar. */
+static void scoreNEON(const float* curves, const int32_t* index,
+		      unsigned int pairs, unsigned int stride,
+		      unsigned int n, float* scores){
+  for(unsigned int d=0; d < n; d += SRP_BLOCK){
+    float32x4_t lo = vdupq_n_f32(0.0f);
+    float32x4_t hi = vdupq_n_f32(0.0f);
+    for(unsigned int p=0; p < pairs; p++){
+      const int32_t* row = index + p*stride + d;
+      lo = vaddq_f32(lo, gatherNEON(curves, row));
+      hi = vaddq_f32(hi, gatherNEON(curves, row + 4));
+    }
+    vst1q_f32(scores + d, lo);
+    vst1q_f32(scores + d + 4, hi);
+  }
+}
+#endif
+
+/*! The kernel locate dispatches to, and its name */
+struct ScoreChoice {
+  ScoreKernel kernel;
+  const char* name;
+};
+
+/*! Every scoring kernel this machine can run, best first. Scalar is
+ *  always last. */
+static unsigned int supportedScoreKernels(ScoreChoice* out){
+  unsigned int n = 0;
+#ifdef SRP_X86
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx2")){
+    out[n++] = ScoreChoice{scoreAVX2, "avx2"};
+  }
+#endif
+#ifdef SRP_NEON
+  out[n++] = ScoreChoice{scoreNEON, "neon"};
+#endif
+  out[n++] = ScoreChoice{scoreScalar, "scalar"};
+  return n;
+}
+
+/*! Decided once, the first time it is needed, unless
+ *  SrpLocator::useKernel changes it */
+static ScoreChoice& scoreChoice(){
+  static ScoreChoice choice = [](){
+    ScoreChoice all[3];
+    supportedScoreKernels(all);
+    return all[0];
+  }();
+  return choice;
+}
+
+SrpLocator::SrpLocator(unsigned int levels, int range) :
+  pairs(numPairs(MIC_LOCATIONS.size())), range(range), grid(levels),
+  best(0) {
+  const std::vector<Vec3>& points = grid.points();
+  unsigned int directions = points.size();
+  coarse = SphereGrid::size(std::min(SRP_START_LEVEL, levels));
+  padded = (coarse + SRP_BLOCK - 1)/SRP_BLOCK*SRP_BLOCK;
+
+  //Sound from u reaches mic i later than mic j by u.(m_j - m_i), so the
+  // correlation of i against j peaks at the opposite lag
+  unsigned int mics = MIC_LOCATIONS.size();
+  unsigned int curveLen = 2*range + 1;
+  index.resize(directions*pairs);
+  for(unsigned int i=0; i < mics; i++){
+    for(unsigned int j=i+1; j < mics; j++){
+      unsigned int p = pairIndex(i, j, mics);
+      for(unsigned int d=0; d < directions; d++){
+	float lag = 0.0f;
+	for(int k=0; k < 3; k++){
+	  lag += points[d][k]*(MIC_LOCATIONS[i][k] - MIC_LOCATIONS[j][k]);
+	}
+	lag *= SPEED_OF_SOUND_SAMPLES_PER_METER;
+	int o = std::max(-range, std::min(range, (int)std::lround(lag)));
+	index[d*pairs + p] = p*curveLen + range + o;
+      }
+    }
+  }
+
+  //The same indexes for the coarse level, turned so the kernel can load
+  // a block of directions at once
+  coarseIndex.resize(pairs*padded);
+  for(unsigned int p=0; p < pairs; p++){
+    for(unsigned int d=0; d < padded; d++){
+      coarseIndex[p*padded + d] = index[std::min(d, coarse - 1)*pairs + p];
+    }
+  }
+  scores.resize(padded);
+}
+
+float SrpLocator::score(const float* curves, unsigned int direction) const {
+  const int32_t* row = index.data() + direction*pairs;
+  float total = 0.0f;
+  for(unsigned int p=0; p < pairs; p++){
+    total += curves[row[p]];
+  }
+  return total;
+}
+
+float SrpLocator::locate(const float* curves, Vec3& dir){
+  //The coarse level is the first directions of the grid, all scored in
+  // one pass of the kernel
+  scoreChoice().kernel(curves, coarseIndex.data(), pairs, padded, padded,
+		       scores.data());
+
+  float total;
+  best = grid.search([this, curves](unsigned int d){
+      return d < coarse ? scores[d] : score(curves, d);
+    }, SRP_START_LEVEL, SRP_BEAM, total);
+  dir = grid.points()[best];
+  return total/pairs;
+}
+
+int SrpLocator::lag(unsigned int pair) const {
+  return index[best*pairs + pair] - (int)(pair*(2*range + 1)) - range;
+}
+
+const char* SrpLocator::kernelName(){
+  return scoreChoice().name;
+}
+
+bool SrpLocator::useKernel(const char* name){
+  ScoreChoice all[3];
+  unsigned int n = supportedScoreKernels(all);
+  for(unsigned int i=0; i < n; i++){
+    if(std::strcmp(all[i].name, name) == 0){
+      scoreChoice() = all[i];
+      return true;
+    }
+  }
+  return false;
+}
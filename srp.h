@@ -0,0 +1,149 @@
+/** \file srp.h
+ * Steered response power: direction of a sound straight from the pair
+ * correlation curves.
+ *
+ * The other solvers only see the peak lag of each pair, so one pair
+ * locking onto an echo throws the direction off. Here every direction of
+ * a fixed sphere grid is scored by adding up, over all pairs, the
+ * correlation at the lag that direction would give, and the best scoring
+ * direction wins. A pair whose highest peak is an echo still adds to the
+ * right direction, just less. With PHAT weighted curves this is SRP-PHAT.
+ *
+ * The lags never change, so they are worked out once, as indexes into the
+ * curves, and scoring is a gather and an add per pair and direction. The
+ * directions come from a SphereGrid: a coarse level is scored in full,
+ * then only the best directions are refined, level by level.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "utils.h"
+#include "spherepoints.h"
+
+/*! Finest SphereGrid level searched. Neighbours at level 6 are about 1
+ *  degree apart. */
+constexpr unsigned int SRP_LEVELS = 6;
+
+/*! SphereGrid level scored in full, 642 directions about 8 degrees
+ *  apart. PHAT peaks are narrow, and from any coarser level the search
+ *  often zooms in on the wrong one. */
+constexpr unsigned int SRP_START_LEVEL = 3;
+
+/*! Directions refined at each finer level */
+constexpr unsigned int SRP_BEAM = 4;
+
+/*! Directions whose mean correlation per pair is below this are dropped,
+ *  like a failed LUT lookup */
+constexpr float MIN_SRP_SCORE = 0.1f;
+
+/*! Scores every direction of a sphere grid against the pair correlation
+ *  curves of one window, for the microphones in MIC_LOCATIONS.
+ *
+ * Usage: call locate once per window, then lag for the delays of the
+ * direction it picked.
+ */
+class SrpLocator {
+ public:
+  /*! Work out the lag of every pair for every direction
+   *
+   * \param levels finest SphereGrid level to search
+   * \param range range of the curves that will be passed to locate: each
+   *        has 2*range+1 lags, from -range to range. Lags outside it are
+   *        clamped to the ends.
+   */
+  SrpLocator(unsigned int levels, int range);
+
+  /*! Find the direction the curves agree on best
+   *
+   * \param curves one curve per pair, in pairIndex order, one after the
+   *        other. curves[p*(2*range+1) + range + o] is the correlation of
+   *        pair p at offset o, as in PairCorrelations, normalized so that
+   *        a perfect match is 1.0.
+   * \param dir receives the unit vector toward the best direction
+   * \return the score of that direction, as the mean correlation per pair
+   */
+  float locate(const float* curves, Vec3& dir);
+
+  /*! Lag of one pair toward the direction picked by the last call to
+   *  locate, in the same sense as delay() in soundProcessing.h
+   *
+   * \param pair index of the pair, from pairIndex
+   */
+  int lag(unsigned int pair) const;
+
+  /*! Number of directions scored by the last call to locate */
+  unsigned int evaluations() const {
+    return grid.evaluations();
+  }
+
+  /*! Score of every direction of SRP_START_LEVEL from the last call to
+   *  locate, summed over pairs, in grid order. Padded at the end with
+   *  copies of the last one. */
+  const std::vector<float>& coarseScores() const {
+    return scores;
+  }
+
+  /*! Name of the scoring kernel in use: "avx2", "neon" or "scalar" */
+  static const char* kernelName();
+
+  /*! Make locate use the named scoring kernel instead of the best one, so
+   *  tests can check each kernel the machine has. Not thread safe: call
+   *  it before any other thread calls locate.
+   *
+   * \param name "avx2", "neon" or "scalar"
+   * \return false, changing nothing, if the CPU can't run that kernel
+   */
+  static bool useKernel(const char* name);
+  
+ private:
+  /*! Score of one direction */
+  float score(const float* curves, unsigned int direction) const;
+  
+  unsigned int pairs;
+  int range;
+
+  /*! The directions */
+  SphereGrid grid;
+  /*! index[d*pairs + p] is where in the curves pair p is read for
+   *  direction d */
+  std::vector<int32_t> index;
+  /*! Number of directions in SRP_START_LEVEL */
+  unsigned int coarse;
+  /*! coarseIndex[p*padded + d] is index[d*pairs + p], for the directions
+   *  of SRP_START_LEVEL. Rows are padded to a whole number of SIMD blocks
+   *  by repeating the last direction. */
+  std::vector<int32_t> coarseIndex;
+  unsigned int padded;
+  /*! Score of every direction of SRP_START_LEVEL, from the last call to
+   *  locate */
+  std::vector<float> scores;
+  /*! Direction picked by the last call to locate */
+  unsigned int best;
+};
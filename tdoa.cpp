@@ -0,0 +1,155 @@
+/** \file tdoa.cpp
+ * Direction of a sound straight from the delays between microphones.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+
+#include "tdoa.h"
+#include "geometry.h"
+
+#include <cmath>
+#include <string>
+
+/*! Pseudo inverse, (A^T A)^-1 A^T, of an n by 3 matrix A
+ *
+ * \param rows the rows of A
+ * \param n number of rows
+ * \param pinv receives the 3 by n result, row major
+ *
+ * \note Throws a std::string if A doesn't have rank 3, which means the
+ *       microphones are all in one plane
+ */
+void pseudoInverse(const Vec3* rows, int n, float* pinv){
+  double a[3][3] = {{0.0}};
+  for(int r=0; r<n; r++){
+    for(int i=0; i<3; i++){
+      for(int j=0; j<3; j++){
+	a[i][j] += (double)rows[r][i]*rows[r][j];
+      }
+    }
+  }
+
+  //Adjugate, transposed cofactors
+  double adj[3][3] = {
+    {a[1][1]*a[2][2] - a[1][2]*a[2][1],
+     a[0][2]*a[2][1] - a[0][1]*a[2][2],
+     a[0][1]*a[1][2] - a[0][2]*a[1][1]},
+    {a[1][2]*a[2][0] - a[1][0]*a[2][2],
+     a[0][0]*a[2][2] - a[0][2]*a[2][0],
+     a[0][2]*a[1][0] - a[0][0]*a[1][2]},
+    {a[1][0]*a[2][1] - a[1][1]*a[2][0],
+     a[0][1]*a[2][0] - a[0][0]*a[2][1],
+     a[0][0]*a[1][1] - a[0][1]*a[1][0]}
+  };
+  double det = a[0][0]*adj[0][0] + a[0][1]*adj[1][0] + a[0][2]*adj[2][0];
+  if(std::fabs(det) < 1e-9){
+    throw std::string("microphone positions don't span 3D,"
+		      " can't solve for direction");
+  }
+
+  for(int i=0; i<3; i++){
+    for(int r=0; r<n; r++){
+      double sum = 0.0;
+      for(int j=0; j<3; j++){
+	sum += adj[i][j]*rows[r][j];
+      }
+      pinv[i*n + r] = (float)(sum/det);
+    }
+  }
+}
+
+/*! Difference between two microphone positions, converted to samples
+ *
+ * \return (m_j - m_i)*SPEED_OF_SOUND_SAMPLES_PER_METER
+ */
+Vec3 micDifference(unsigned int i, unsigned int j){
+  Vec3 ret;
+  for(int k=0; k<3; k++){
+    ret[k] = (MIC_LOCATIONS[j][k] - MIC_LOCATIONS[i][k])
+      *SPEED_OF_SOUND_SAMPLES_PER_METER;
+  }
+  return ret;
+}
+
+TdoaSolver::TdoaSolver(){
+  unsigned int mics = MIC_LOCATIONS.size();
+  rows0.resize(mics - 1);
+  pinv0.resize(3*rows0.size());
+  rowsAll.resize(numPairs(mics));
+  pinvAll.resize(3*rowsAll.size());
+  
+  for(unsigned int j=1; j<mics; j++){
+    rows0[j-1] = micDifference(0, j);
+  }
+  for(unsigned int i=0; i<mics; i++){
+    for(unsigned int j=i+1; j<mics; j++){
+      rowsAll[pairIndex(i, j, mics)] = micDifference(i, j);
+    }
+  }
+  
+  pseudoInverse(rows0.data(), rows0.size(), pinv0.data());
+  pseudoInverse(rowsAll.data(), rowsAll.size(), pinvAll.data());
+}
+
+float TdoaSolver::solveFirst(const float* offsets, Vec3& dir) const {
+  return solve(offsets, rows0.data(), pinv0.data(), rows0.size(), dir);
+}
+
+float TdoaSolver::solve(const std::vector<float>& offsets,
+			Vec3& dir) const {
+  return solve(offsets.data(), rowsAll.data(), pinvAll.data(),
+	       rowsAll.size(), dir);
+}
+
+float TdoaSolver::solve(const float* offsets, const Vec3* rows,
+			const float* pinv, int n, Vec3& dir){
+  Vec3 u;
+  for(int i=0; i<3; i++){
+    u[i] = 0.0f;
+    for(int r=0; r<n; r++){
+      u[i] += pinv[i*n + r]*offsets[r];
+    }
+  }
+
+  //For a far away sound u comes out close to unit length. Normalizing
+  // gives the direction; how badly the unit vector then fits the delays
+  // is the residual.
+  float mag = std::sqrt(u[0]*u[0] + u[1]*u[1] + u[2]*u[2]);
+  //Written so that NaN fails too
+  if(!(mag > 1e-6f)){
+    dir = {10.0f, 10.0f, 10.0f};
+    return 0.0f;
+  }
+  dir = {u[0]/mag, u[1]/mag, u[2]/mag};
+
+  float sumSq = 0.0f;
+  for(int r=0; r<n; r++){
+    float err = rows[r][0]*dir[0] + rows[r][1]*dir[1] + rows[r][2]*dir[2]
+      - offsets[r];
+    sumSq += err*err;
+  }
+  return 1.0f/(1.0f + std::sqrt(sumSq/n));
+}
@@ -0,0 +1,99 @@
+/** \file tdoa.h
+ * Direction of a sound straight from the delays between microphones.
+ *
+ * For a far away sound coming from unit direction u, the difference in
+ * distance from the sound to mics i and j is u.(m_j - m_i). Each measured
+ * pair delay gives one such linear equation in u, so the direction can be
+ * solved for directly, by least squares, instead of being looked up in
+ * LocationLUT. It works with fractional delays too, and needs no table.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+
+#pragma once
+
+#include <vector>
+
+#include "constants.h"
+#include "soundProcessing.h"
+#include "utils.h"
+
+/*! Least squares direction solver for the microphone geometry in
+ *  MIC_LOCATIONS. All the matrix work is done once, in the constructor, so
+ *  solving is a handful of multiply-adds.
+ */
+class TdoaSolver {
+ public:
+  /*! Precompute the pseudo inverses for the current MIC_LOCATIONS */
+  TdoaSolver();
+
+  /*! Direction from the delays against channel 0
+   *
+   * \param offsets offsets[i] is t_0 - t_(i+1) in samples: how much later
+   *        the sound reached channel 0 than channel i+1, one for each
+   *        microphone after the first. For 4 microphones, the same as the key of
+   *        LocationLUT::get
+   * \param dir receives a unit vector pointing toward the sound, or
+   *        {10, 10, 10} if the delays don't give a direction
+   * \return confidence between 0 and 1: 1/(1 + r), where r is the root
+   *         mean square, in samples, by which dir fails to explain the
+   *         delays. 0 if there is no direction.
+   */
+  float solveFirst(const float* offsets, Vec3& dir) const;
+
+  /*! Direction from the delays between every pair of channels. With more
+   *  equations than unknowns, the residual also catches delays that
+   *  disagree with each other.
+   *
+   * \param offsets offsets[pairIndex(i, j, n)] is t_i - t_j in samples:
+   *        how much later the sound reached channel i than channel j, for
+   *        all numPairs(n) pairs of the n microphones
+   * \param dir as above
+   * \return as above
+   */
+  float solve(const std::vector<float>& offsets, Vec3& dir) const;
+
+ private:
+  /*! Shared part of both versions of solve
+   *
+   * \param offsets measured delays, one per row
+   * \param rows the rows of the system, scaled to samples
+   * \param pinv pseudo inverse of rows, 3 by n
+   * \param n number of rows
+   * \param dir receives the direction
+   */
+  static float solve(const float* offsets, const Vec3* rows,
+		     const float* pinv, int n, Vec3& dir);
+  
+  /*! (m_j - m_0)*SPEED_OF_SOUND_SAMPLES_PER_METER for j = 1 to n-1 */
+  std::vector<Vec3> rows0;
+  /*! Pseudo inverse of rows0, row major 3 by n-1 */
+  std::vector<float> pinv0;
+  /*! (m_j - m_i)*SPEED_OF_SOUND_SAMPLES_PER_METER at pairIndex(i, j, n) */
+  std::vector<Vec3> rowsAll;
+  /*! Pseudo inverse of rowsAll, row major 3 by numPairs(n) */
+  std::vector<float> pinvAll;
+};
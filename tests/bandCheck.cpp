@@ -0,0 +1,138 @@
+/** \file bandCheck.cpp
+ * Checks that BandLocalizer gives bit for bit the same offsets, strength
+ * and level in every band whether the bands are spread over several
+ * threads or all done by the calling thread. process is called back to
+ * back on small clips, so the workers are often still finishing one clip
+ * when the next is handed out, and a worker left over from the last clip
+ * takes bands of the new one.
+ *
+ * Run with make check.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <algorithm>
+#include <memory>
+#include <cmath>
+
+#include "../bandLocalizer.h"
+#include "../soundFrame.h"
+#include "../constants.h"
+
+/*! Failures so far */
+int failures = 0;
+
+/*! Count a failure and say where it was, if the two differ */
+template<typename T>
+void expect(const T& got, const T& want, const char* what,
+	    unsigned int threads, unsigned int clip, unsigned int band){
+  if(!(got == want)){
+    if(failures < 10){
+      std::cerr << threads << " threads, clip " << clip << ", band " << band
+		<< ": " << what << " differ" << std::endl;
+    }
+    failures++;
+  }
+}
+
+/*! Run the same clips through one BandLocalizer per thread count, and
+ *  compare every band of every clip against the single threaded one
+ *
+ * \return number of clips checked
+ */
+unsigned int check(unsigned int frames, unsigned int channels, int range,
+		   unsigned int bands, std::mt19937& rng){
+  const unsigned int clips = 400;
+  const std::vector<unsigned int> threads = {1, 2, 3, bands};
+
+  std::vector<std::unique_ptr<BandLocalizer> > localizers;
+  for(unsigned int t : threads){
+    localizers.emplace_back(new BandLocalizer(frames, channels, range, bands,
+					      t));
+  }
+
+  //Noise, plus a hum and a click train reaching each channel at different
+  // times, so different bands find different delays
+  std::uniform_int_distribution<int> noise(-2000, 2000);
+  std::vector<std::vector<int16_t> > signal(channels,
+					    std::vector<int16_t>(frames));
+  const int16_t* ch[MAX_CHANNELS];
+  SoundFrame frame(frames, channels);
+  
+  for(unsigned int clip=0; clip < clips; clip++){
+    int hum = rng() % 7;
+    int click = rng() % 11;
+    for(unsigned int c=0; c < channels; c++){
+      for(unsigned int i=0; i < frames; i++){
+	int v = noise(rng);
+	v += (int)(8000*std::sin(0.05f*(i + hum*c)));
+	if((i + click*c) % 97 < 3) v += 12000;
+	signal[c][i] = (int16_t)std::max(-32768, std::min(32767, v));
+      }
+      ch[c] = signal[c].data();
+    }
+    frame.set(ch, frames, channels);
+    bool subsample = clip % 2 == 0;
+
+    //Every clip goes through all of them before any results are read, and
+    // the results aren't read until the next clip is built
+    for(std::unique_ptr<BandLocalizer>& l : localizers){
+      l->process(frame, subsample);
+    }
+    const BandLocalizer& want = *localizers[0];
+    for(unsigned int t=1; t < threads.size(); t++){
+      const BandLocalizer& got = *localizers[t];
+      for(unsigned int b=0; b < bands; b++){
+	expect(got.offsets(b), want.offsets(b), "offsets", threads[t], clip, b);
+	expect(got.strength(b), want.strength(b), "strengths", threads[t],
+	       clip, b);
+	expect(got.level(b), want.level(b), "levels", threads[t], clip, b);
+      }
+    }
+  }
+  return clips;
+}
+
+int main(){
+  std::mt19937 rng(2016);
+  unsigned int clips = 0;
+  //Tiny clips, so each band takes microseconds and the workers race each
+  // other for the next clip, then clips of the usual size
+  clips += check(64, 4, 8, MAX_BANDS, rng);
+  clips += check(256, 6, 16, MAX_BANDS, rng);
+  clips += check(1067, 4, 20, 5, rng);
+
+  if(failures > 0){
+    std::cout << "FAILED: " << failures << " mismatches" << std::endl;
+    return 1;
+  }
+  std::cout << "BandLocalizer matches across thread counts on " << clips
+	    << " clips" << std::endl;
+  return 0;
+}
@@ -0,0 +1,82 @@
+/** \file bruteSpacing.h
+ * The obvious way to find the nearest neighbour spacing of a point set:
+ * compare every pair. It takes O(n^2) time, which is too slow for big
+ * sets, but it is simple enough to trust, so tests compare pointSpacing
+ * to it.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "../spherepoints.h"
+
+/*! pointSpacing, by comparing every pair of points. The points are
+ *  scaled to unit length and the angles and histogram are worked out from
+ *  the distances the same way, so the results should be exactly equal. */
+inline SpacingStats bruteSpacing(std::vector<Vec3> pts,
+				 unsigned int bins = 10){
+  SpacingStats ret = {0.0f, 0.0f, 0.0f, std::vector<unsigned int>(bins, 0)};
+  if(pts.size() < 2){
+    return ret;
+  }
+
+  for(Vec3& p : pts){
+    float len = std::sqrt(p[0]*p[0] + p[1]*p[1] + p[2]*p[2]);
+    p = Vec3{p[0]/len, p[1]/len, p[2]/len};
+  }
+
+  std::vector<float> nearest(pts.size(), 4.0f);
+  for(unsigned int i=0; i < pts.size(); i++){
+    for(unsigned int j=i+1; j < pts.size(); j++){
+      float d = dist(pts[i], pts[j]);
+      nearest[i] = std::min(nearest[i], d);
+      nearest[j] = std::min(nearest[j], d);
+    }
+  }
+
+  double total = 0.0;
+  ret.minAngle = 10.0f;
+  for(float& n : nearest){
+    n = 2*std::asin(std::min(1.0f, n/2));
+    ret.minAngle = std::min(ret.minAngle, n);
+    ret.maxAngle = std::max(ret.maxAngle, n);
+    total += n;
+  }
+  ret.meanAngle = total/nearest.size();
+
+  float width = (ret.maxAngle - ret.minAngle)/std::max(1u, bins);
+  for(float n : nearest){
+    if(bins == 0) break;
+    unsigned int bin = width > 0.0f ? (n - ret.minAngle)/width : 0;
+    ret.histogram[std::min(bin, bins - 1)]++;
+  }
+
+  return ret;
+}
@@ -0,0 +1,171 @@
+/** \file coarseBench.cpp
+ * Compares the coarse to fine lag search with the exhaustive one, for
+ * speed and for how often they agree, on a few kinds of sound with known
+ * delays.
+ *
+ * Run with make bench.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "../coarseSearch.h"
+#include "../soundProcessing.h"
+#include "../soundFrame.h"
+#include "../constants.h"
+
+/*! Kinds of test sound */
+enum class Sound { WHITE, LOWPASS, VOICED, NOISY, TONE };
+
+/*! Names of the kinds of Sound, for printing */
+const char* SOUND_NAMES[] = {"white noise", "low passed noise",
+			     "voiced (modulated tone)",
+			     "white noise, SNR -9.5 dB",
+			     "tone with a period of 7 samples, SNR 3 dB"};
+
+/*! One period of a sound that reaches channel ch delays[ch] samples
+ *  later than it reaches the source */
+std::vector<int16_t> makeFrame(Sound kind, unsigned int frames, int range,
+			       const int* delays, std::mt19937& rng){
+  std::normal_distribution<float> normal(0.0f, 1.0f);
+  std::vector<float> src(frames + 2*range + 50);
+  float lp = 0.0f;
+  for(size_t i=0; i < src.size(); i++){
+    float w = normal(rng);
+    switch(kind){
+    case Sound::WHITE:
+    case Sound::NOISY:
+    case Sound::TONE:
+      src[i] = w;
+      break;
+    case Sound::LOWPASS:
+      lp = 0.7f*lp + 0.3f*w;
+      src[i] = 2.0f*lp;
+      break;
+    case Sound::VOICED:
+      lp = 0.9f*lp + w;
+      src[i] = std::sin(i*0.3f)*lp + 0.3f*w;
+      break;
+    }
+  }
+  std::vector<int16_t> buffer(frames*NUM_CHANNELS);
+  for(unsigned int i=0; i < frames; i++){
+    for(unsigned int ch=0; ch < NUM_CHANNELS; ch++){
+      float v = 3000.0f*src[i + range + 10 - delays[ch]];
+      if(kind == Sound::NOISY){
+	//Uncorrelated between channels
+	v += 9000.0f*normal(rng);
+      } else if(kind == Sound::TONE){
+	//Repeats every 7 samples, so lags 7 apart look alike
+	v = 3000.0f*std::sin((i - delays[ch])*0.9f) + 1500.0f*normal(rng);
+      }
+      buffer[i*NUM_CHANNELS + ch]
+	= (int16_t)std::max(-32000.0f, std::min(32000.0f, v));
+    }
+  }
+  return buffer;
+}
+
+int main(){
+  typedef std::chrono::steady_clock clock;
+  const unsigned int frames = (unsigned int)(SAMPLES_PER_SECOND
+					     /TARGET_FRAME_RATE + 0.5f);
+  const int range = (int)(2*SENSOR_SPACING_SAMPLES);
+  const int trials = 300;
+  const unsigned int maxCandidates = 3;
+  std::mt19937 rng(19);
+
+  std::cout << frames << " samples, lags -" << range + 2 << " to "
+	    << range + 2 << ", pairs (0, 1) to (0, 3)" << std::endl
+	    << std::fixed << std::setprecision(2);
+  for(Sound kind : {Sound::WHITE, Sound::LOWPASS, Sound::VOICED,
+	Sound::NOISY, Sound::TONE}){
+    DspWorkspace ws(range + 2);
+    CoarseSearch coarse(range);
+    double exhaustiveUs = 0.0, exhaustiveErr = 0.0;
+    double coarseUs[maxCandidates + 1] = {}, coarseErr[maxCandidates + 1] = {};
+    int same[maxCandidates + 1] = {};
+    int pairs = 0;
+    
+    for(int t=0; t < trials; t++){
+      int delays[NUM_CHANNELS] = {0};
+      for(unsigned int ch=1; ch < NUM_CHANNELS; ch++){
+	delays[ch] = (int)(rng() % (2*range + 1)) - range;
+      }
+      SoundFrame frame(makeFrame(kind, frames, range, delays, rng));
+
+      std::pair<float, float> full[NUM_CHANNELS];
+      clock::time_point start = clock::now();
+      for(unsigned int j=1; j < NUM_CHANNELS; j++){
+	full[j] = delay(frame, 0, j, range, ws, true);
+      }
+      exhaustiveUs += std::chrono::duration<double, std::micro>(clock::now()
+								- start)
+	.count();
+      for(unsigned int j=1; j < NUM_CHANNELS; j++){
+	//Pair (0, j) peaks at t_j - t_0, which is delays[j] - delays[0]
+	exhaustiveErr += std::fabs(full[j].first - delays[j]);
+	pairs++;
+      }
+      
+      for(unsigned int k=1; k <= maxCandidates; k++){
+	std::pair<float, float> found[NUM_CHANNELS];
+	start = clock::now();
+	coarse.setFrame(frame);
+	for(unsigned int j=1; j < NUM_CHANNELS; j++){
+	  found[j] = coarse.delay(0, j, range, k, true);
+	}
+	coarseUs[k] += std::chrono::duration<double, std::micro>(clock::now()
+								 - start)
+	  .count();
+	for(unsigned int j=1; j < NUM_CHANNELS; j++){
+	  same[k] += found[j] == full[j];
+	  coarseErr[k] += std::fabs(found[j].first - delays[j]);
+	}
+      }
+    }
+
+    std::cout << SOUND_NAMES[(int)kind] << std::endl
+	      << "  exhaustive          " << std::setw(7)
+	      << exhaustiveUs/trials << " us, mean error "
+	      << exhaustiveErr/pairs << " samples" << std::endl;
+    for(unsigned int k=1; k <= maxCandidates; k++){
+      std::cout << "  coarse, " << k << " candidate" << (k > 1 ? "s" : " ")
+		<< "  " << std::setw(7) << coarseUs[k]/trials
+		<< " us, mean error " << coarseErr[k]/pairs << " samples, "
+		<< std::setprecision(1) << 100.0*same[k]/pairs
+		<< "% same as exhaustive" << std::setprecision(2) << std::endl;
+    }
+  }
+  return 0;
+}
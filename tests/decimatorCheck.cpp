@@ -0,0 +1,238 @@
+/** \file decimatorCheck.cpp
+ * Checks Decimator: that a signal cut into short periods comes out the
+ * same as in long ones, that the gain at DC is exactly 1, that the pass
+ * band is flat and the stop band is well down at factors 3 and 6, and
+ * that outputs past the 16 bit range are clamped, not wrapped.
+ *
+ * Run with make check.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+#include "../decimator.h"
+
+/*! Failures so far */
+int failures = 0;
+
+/*! Count a failure and say what it was */
+void fail(const std::string& what){
+  if(failures < 10){
+    std::cerr << what << std::endl;
+  }
+  failures++;
+}
+
+/*! Run a multichannel signal through a decimator in periods of the given
+ *  length
+ *
+ * \param signal signal[ch] is one channel, a whole number of periods long
+ * \return the output, one vector per channel
+ */
+std::vector<std::vector<int16_t> >
+decimate(const std::vector<std::vector<int16_t> >& signal,
+	 unsigned int factor, unsigned int period){
+  unsigned int channels = signal.size();
+  Decimator d(channels, factor);
+  std::vector<std::vector<int16_t> > ret(channels);
+  std::vector<int16_t> in(channels*period), out;
+  for(unsigned int start=0; start < signal[0].size(); start += period){
+    for(unsigned int ch=0; ch < channels; ch++){
+      std::copy(signal[ch].begin() + start,
+		signal[ch].begin() + start + period,
+		in.begin() + ch*period);
+    }
+    d.process(in, out);
+    unsigned int outFrames = period/factor;
+    for(unsigned int ch=0; ch < channels; ch++){
+      ret[ch].insert(ret[ch].end(), out.begin() + ch*outFrames,
+		     out.begin() + (ch + 1)*outFrames);
+    }
+  }
+  return ret;
+}
+
+/*! Root mean square of the samples from skip on */
+double rms(const std::vector<int16_t>& x, unsigned int skip){
+  double total = 0.0;
+  for(unsigned int i=skip; i < x.size(); i++){
+    total += (double)x[i]*x[i];
+  }
+  return std::sqrt(total/(x.size() - skip));
+}
+
+/*! A period cut into pieces, even ones that aren't a whole number of
+ *  filter lengths, must give exactly what the whole period gives */
+void checkSplit(std::mt19937& rng){
+  std::uniform_int_distribution<int> sample(-32768, 32767);
+  for(unsigned int factor : {2u, 3u, 6u}){
+    unsigned int whole = 60*factor*DECIMATOR_TAPS_PER_PHASE/4;
+    std::vector<std::vector<int16_t> > signal(4,
+					      std::vector<int16_t>(8*whole));
+    for(std::vector<int16_t>& ch : signal){
+      for(int16_t& s : ch) s = sample(rng);
+    }
+    std::vector<std::vector<int16_t> > want = decimate(signal, factor, whole);
+    for(unsigned int pieces : {2u, 4u, 5u}){
+      if(whole % (pieces*factor) != 0) continue;
+      if(decimate(signal, factor, whole/pieces) != want){
+	fail("factor " + std::to_string(factor) + ": periods cut in "
+	     + std::to_string(pieces) + " differ from whole ones");
+      }
+    }
+  }
+}
+
+/*! Once the filter has filled up, a constant comes out unchanged, since
+ *  the taps add up to exactly 1 in Q15 */
+void checkDC(){
+  for(unsigned int factor=2; factor <= 6; factor++){
+    unsigned int period = 64*factor;
+    for(int level : {1, -1, 12345, -20000, 32767, -32768}){
+      std::vector<std::vector<int16_t> > signal(2,
+	std::vector<int16_t>(8*period, (int16_t)level));
+      std::vector<std::vector<int16_t> > out = decimate(signal, factor,
+							period);
+      for(unsigned int i=DECIMATOR_TAPS_PER_PHASE; i < out[0].size(); i++){
+	if(out[0][i] != level || out[1][i] != level){
+	  fail("factor " + std::to_string(factor) + ": DC of "
+	       + std::to_string(level) + " came out as "
+	       + std::to_string(out[0][i]));
+	  break;
+	}
+      }
+    }
+  }
+}
+
+/*! The Blackman window's side lobes are about 74 dB down, and rounding
+ *  the taps to Q15 costs a few dB more. The worst seen is about 68. */
+constexpr double MIN_STOPBAND_DB = 65.0;
+
+/*! Gain of a sine wave through the decimator
+ *
+ * \param cycles frequency, in cycles per output sample
+ */
+double sineGain(unsigned int factor, double cycles){
+  unsigned int period = 256*factor;
+  std::vector<std::vector<int16_t> > signal(1,
+					    std::vector<int16_t>(16*period));
+  const double amplitude = 30000.0;
+  for(unsigned int i=0; i < signal[0].size(); i++){
+    signal[0][i] = (int16_t)std::lround(amplitude
+					*std::sin(2*M_PI*cycles*i/factor));
+  }
+  std::vector<std::vector<int16_t> > out = decimate(signal, factor, period);
+  return rms(out[0], 2*DECIMATOR_TAPS_PER_PHASE)/(amplitude/std::sqrt(2.0));
+}
+
+/*! Flat up to half the output Nyquist frequency, and at least
+ *  MIN_STOPBAND_DB down from 1.25 times it up to the input Nyquist
+ *  frequency. For 16 kHz out, that is 1 to 4 kHz, and 10 kHz up. */
+void checkResponse(){
+  for(unsigned int factor : {3u, 6u}){
+    for(double cycles : {0.0625, 0.125, 0.1875, 0.25}){
+      double gain = sineGain(factor, cycles);
+      if(std::fabs(gain - 1.0) > 0.01){
+	fail("factor " + std::to_string(factor) + ": gain "
+	     + std::to_string(gain) + " at " + std::to_string(cycles)
+	     + " cycles per output sample");
+      }
+    }
+    double worst = 0.0;
+    for(double cycles=0.625; cycles < 0.495*factor; cycles += 0.05){
+      double gain = sineGain(factor, cycles);
+      worst = std::max(worst, gain);
+      if(20*std::log10(gain) > -MIN_STOPBAND_DB){
+	fail("factor " + std::to_string(factor) + ": only "
+	     + std::to_string(-20*std::log10(gain)) + " dB down at "
+	     + std::to_string(cycles) + " cycles per output sample");
+      }
+    }
+    std::cout << "  factor " << factor << ": stop band at least "
+	      << -20*std::log10(worst) << " dB down" << std::endl;
+  }
+}
+
+/*! A full scale square wave overshoots at every edge. The overshoot must
+ *  stick at the ends of the 16 bit range, not wrap round to the other
+ *  sign. */
+void checkClamping(){
+  for(unsigned int factor : {2u, 3u, 6u}){
+    unsigned int period = 240*factor;
+    unsigned int halfWave = 40*factor;
+    std::vector<std::vector<int16_t> > signal(1,
+					      std::vector<int16_t>(8*period));
+    for(unsigned int i=0; i < signal[0].size(); i++){
+      signal[0][i] = (i/halfWave) % 2 ? -32768 : 32767;
+    }
+    std::vector<std::vector<int16_t> > out = decimate(signal, factor,
+						      period);
+    int16_t high = *std::max_element(out[0].begin(), out[0].end());
+    int16_t low = *std::min_element(out[0].begin(), out[0].end());
+    if(high != 32767 || low != -32768){
+      fail("factor " + std::to_string(factor) + ": full scale square wave "
+	   + "came out between " + std::to_string(low) + " and "
+	   + std::to_string(high));
+    }
+    //Well inside each half wave, away from the ringing, the output has
+    // the sign of the input
+    unsigned int outHalf = halfWave/factor;
+    for(unsigned int i=2*DECIMATOR_TAPS_PER_PHASE; i < out[0].size(); i++){
+      unsigned int in = i*factor - (DECIMATOR_TAPS_PER_PHASE*factor - 1)/2;
+      unsigned int into = (in % halfWave)/factor;
+      if(into < outHalf/4 || into > 3*outHalf/4) continue;
+      bool high = (in/halfWave) % 2 == 0;
+      if(high ? out[0][i] < 16384 : out[0][i] > -16384){
+	fail("factor " + std::to_string(factor) + ": output "
+	     + std::to_string(out[0][i]) + " at " + std::to_string(i)
+	     + " has wrapped");
+	break;
+      }
+    }
+  }
+}
+
+int main(){
+  std::mt19937 rng(16);
+  checkSplit(rng);
+  checkDC();
+  checkResponse();
+  checkClamping();
+
+  if(failures > 0){
+    std::cout << "FAILED: " << failures << " checks" << std::endl;
+    return 1;
+  }
+  std::cout << "Decimator is continuous across periods, exact at DC, "
+	    << "and clamps" << std::endl;
+  return 0;
+}
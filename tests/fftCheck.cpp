@@ -0,0 +1,129 @@
+/** \file fftCheck.cpp
+ * Checks RealFFT against a plain O(n^2) DFT, done in double precision:
+ * forward on random signals, inverse on the spectra of random signals,
+ * and the round trip, for every power of two length from 4 to 4096.
+ *
+ * Run with make check.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include <iostream>
+#include <vector>
+#include <complex>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+#include "../fft.h"
+
+/*! The first n/2+1 bins of the DFT of a real signal */
+static std::vector<std::complex<double> >
+naiveForward(const std::vector<float>& x){
+  unsigned int n = x.size();
+  std::vector<std::complex<double> > out(n/2 + 1);
+  for(unsigned int k=0; k <= n/2; k++){
+    std::complex<double> total = 0.0;
+    for(unsigned int t=0; t < n; t++){
+      double a = -2.0*M_PI*(double)k*t/n;
+      total += (double)x[t]*std::complex<double>(std::cos(a), std::sin(a));
+    }
+    out[k] = total;
+  }
+  return out;
+}
+
+/*! The real signal of length n with the given first n/2+1 bins, scaled
+ *  by 1/n like RealFFT::inverse */
+static std::vector<double>
+naiveInverse(const std::vector<std::complex<float> >& bins, unsigned int n){
+  std::vector<double> out(n);
+  for(unsigned int t=0; t < n; t++){
+    double total = 0.0;
+    for(unsigned int k=0; k < n; k++){
+      //The bins above Nyquist mirror the ones below
+      std::complex<double> b = k <= n/2 ? std::complex<double>(bins[k])
+	: std::conj(std::complex<double>(bins[n - k]));
+      double a = 2.0*M_PI*(double)k*t/n;
+      total += (b*std::complex<double>(std::cos(a), std::sin(a))).real();
+    }
+    out[t] = total/n;
+  }
+  return out;
+}
+
+int main(){
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+  int failures = 0;
+
+  for(unsigned int n=4; n <= 4096; n *= 2){
+    RealFFT fft(n);
+    std::vector<float> x(n), back(n);
+    for(float& v : x) v = uniform(rng);
+    std::vector<std::complex<float> > spectrum(n/2 + 1);
+
+    //Errors relative to the size of the values involved. Float rounding
+    // grows with log n, and stays far below this.
+    fft.forward(x.data(), spectrum.data());
+    std::vector<std::complex<double> > want = naiveForward(x);
+    double scale = 0.0, forwardErr = 0.0;
+    for(unsigned int k=0; k <= n/2; k++){
+      scale = std::max(scale, std::abs(want[k]));
+      forwardErr = std::max(forwardErr,
+			    std::abs(std::complex<double>(spectrum[k])
+				     - want[k]));
+    }
+    forwardErr /= scale;
+
+    //The imaginary parts of DC and Nyquist are ignored by a real inverse,
+    // so they are left as forward made them
+    fft.inverse(spectrum.data(), back.data());
+    std::vector<double> inverse = naiveInverse(spectrum, n);
+    double inverseErr = 0.0, roundTripErr = 0.0;
+    for(unsigned int t=0; t < n; t++){
+      inverseErr = std::max(inverseErr, std::fabs(back[t] - inverse[t]));
+      roundTripErr = std::max(roundTripErr, (double)std::fabs(back[t] - x[t]));
+    }
+
+    const double tolerance = 1e-5;
+    bool ok = forwardErr < tolerance && inverseErr < tolerance
+      && roundTripErr < tolerance;
+    if(!ok){
+      std::cerr << "length " << n << ": forward error " << forwardErr
+		<< ", inverse error " << inverseErr << ", round trip error "
+		<< roundTripErr << std::endl;
+      failures++;
+    }
+  }
+
+  if(failures > 0){
+    std::cout << "FAILED: " << failures << " lengths" << std::endl;
+    return 1;
+  }
+  std::cout << "RealFFT matches the plain DFT at every length from 4 to 4096"
+	    << std::endl;
+  return 0;
+}
@@ -0,0 +1,252 @@
+/** \file gateCheck.cpp
+ * Checks NoiseGate on a simulated site, at one window per period and at
+ * a quarter period hop: every sound gets through, a steady hum is
+ * absorbed into the floor in the time the floor's rise rate says, the
+ * gate holds open for GATE_HOLD_SECONDS after a sound, silent frames are
+ * counted, and the floors start over when the number of channels
+ * changes.
+ *
+ * Run with make check.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include <utility>
+
+#include "../noiseGate.h"
+#include "../constants.h"
+
+/*! Failures so far */
+int failures = 0;
+
+/*! Count a failure and say what it was */
+void fail(const std::string& what){
+  if(failures < 10){
+    std::cerr << what << std::endl;
+  }
+  failures++;
+}
+
+/*! Feeds a NoiseGate frames whose channels have the given standard
+ *  deviations, give or take a little, the way main does */
+class Site {
+ public:
+  Site(float secondsPerFrame, unsigned int channels, std::mt19937& rng) :
+    gate(secondsPerFrame), channels(channels), rng(rng),
+    stats(channels) {
+  }
+
+  /*! One frame at the given level on every channel
+   *
+   * \return whether the gate passed it
+   */
+  bool frame(float level){
+    std::uniform_real_distribution<float> wobble(0.9f, 1.1f);
+    float loudness = 0.0f;
+    for(std::pair<float, float>& s : stats){
+      s = std::make_pair(0.0f, level*wobble(rng));
+      loudness = std::max(loudness, s.second);
+    }
+    return gate.update(stats, loudness);
+  }
+
+  NoiseGate gate;
+  unsigned int channels;
+  std::mt19937& rng;
+  std::vector<std::pair<float, float> > stats;
+};
+
+/*! Quiet background, with a short sound every 100 periods. Halfway
+ *  through the background rises to a hum five times as loud. Every
+ *  sound must be passed, and once the hum has been absorbed nearly
+ *  everything else gated. */
+void checkSite(const std::string& name, unsigned int framesPerPeriod,
+	       std::mt19937& rng){
+  const float secondsPerPeriod = 1.0f/TARGET_FRAME_RATE;
+  Site site(secondsPerPeriod/framesPerPeriod, NUM_CHANNELS, rng);
+  const unsigned int periods = 3000;
+  const float quiet = 300.0f, hum = 1500.0f, sound = 10000.0f;
+  unsigned int sounds = 0, heard = 0, background = 0, passed = 0;
+  for(unsigned int p=0; p < periods; p++){
+    bool isSound = p % 100 == 50;
+    float level = isSound ? sound : p < periods/2 ? quiet : hum;
+    bool any = false;
+    for(unsigned int f=0; f < framesPerPeriod; f++){
+      bool open = site.frame(level);
+      any = any || open;
+      //Ten seconds after the hum starts it should be part of the floor.
+      // Frames held open after a sound don't count against the gate.
+      if(!isSound && p % 100 > 55 && (p < periods/2 - 100
+				       || p > periods/2 + 150)){
+	background++;
+	passed += open;
+      }
+    }
+    if(isSound){
+      sounds++;
+      heard += any;
+    }
+  }
+
+  if(heard != sounds){
+    fail(name + ": " + std::to_string(heard) + " of "
+	 + std::to_string(sounds) + " sounds passed");
+  }
+  float share = (float)passed/background;
+  if(share > 0.01f){
+    fail(name + ": " + std::to_string(100*share)
+	 + "% of background frames passed");
+  }
+  std::cout << "  " << name << ": " << heard << " of " << sounds
+	    << " sounds passed, " << 100*share << "% of settled background"
+	    << std::endl;
+}
+
+/*! A hum five times the settled floor starts and never stops. The floor
+ *  rises towards it as 1 - exp(-t/NOISE_FLOOR_RISE_SECONDS), from 1/5 of
+ *  the hum to 1/GATE_RATIO of it after NOISE_FLOOR_RISE_SECONDS*ln(4/2.5)
+ *  seconds, about 3.05, and the gate closes once the hold after that runs
+ *  out. Exact levels, so the time doesn't depend on the wobble. */
+void checkHum(const std::string& name, float secondsPerFrame){
+  NoiseGate gate(secondsPerFrame);
+  const float quiet = 300.0f, hum = 5*quiet;
+  std::vector<std::pair<float, float> > stats(NUM_CHANNELS,
+					      std::make_pair(0.0f, quiet));
+  for(unsigned int f=0; f < 20/secondsPerFrame; f++){
+    gate.update(stats, quiet);
+  }
+  const float expected = NOISE_FLOOR_RISE_SECONDS
+    *std::log((hum - quiet)/(hum - hum/GATE_RATIO)) + GATE_HOLD_SECONDS;
+  float closed = -1.0f;
+  stats.assign(NUM_CHANNELS, std::make_pair(0.0f, hum));
+  for(unsigned int f=0; f < 20/secondsPerFrame; f++){
+    if(!gate.update(stats, hum)){
+      closed = f*secondsPerFrame;
+      break;
+    }
+  }
+  if(closed < 0.0f || std::fabs(closed - expected) > secondsPerFrame){
+    fail(name + ": hum gated after " + std::to_string(closed)
+	 + " s, expected about " + std::to_string(expected));
+  }
+  std::cout << "  " << name << ": hum gated after " << closed
+	    << " s, expected " << expected << std::endl;
+}
+
+/*! One loud frame after a settled quiet stretch. The gate must stay open
+ *  for GATE_HOLD_SECONDS after it, to within a frame. */
+void checkHold(const std::string& name, float secondsPerFrame,
+	       std::mt19937& rng){
+  Site site(secondsPerFrame, NUM_CHANNELS, rng);
+  const float quiet = 300.0f;
+  for(unsigned int f=0; f < 5/secondsPerFrame; f++){
+    site.frame(quiet);
+  }
+  if(!site.frame(10*quiet)){
+    fail(name + ": a loud frame was gated");
+  }
+  unsigned int held = 0;
+  while(site.frame(quiet) && held < 10/secondsPerFrame){
+    held++;
+  }
+  float seconds = held*secondsPerFrame;
+  if(std::fabs(seconds - GATE_HOLD_SECONDS) > secondsPerFrame){
+    fail(name + ": held open for " + std::to_string(seconds)
+	 + " s, expected " + std::to_string(GATE_HOLD_SECONDS));
+  }
+  std::cout << "  " << name << ": held open for " << seconds << " s"
+	    << std::endl;
+}
+
+/*! Frames below SILENCE_LOUDNESS are gated and counted as silent, and a
+ *  change in the number of channels starts the floors over from the
+ *  next frame, which is passed */
+void checkCounting(std::mt19937& rng){
+  Site site(1.0f/TARGET_FRAME_RATE, NUM_CHANNELS, rng);
+  if(!site.frame(400.0f)){
+    fail("the first frame was gated");
+  }
+  for(int f=0; f < 100; f++){
+    site.frame(400.0f);
+  }
+  unsigned long silent = site.gate.stats().silent;
+  for(int f=0; f < 10; f++){
+    if(site.frame(SILENCE_LOUDNESS/2)){
+      fail("a silent frame was passed");
+    }
+  }
+  if(site.gate.stats().silent != silent + 10){
+    fail("silent frames counted " + std::to_string(site.gate.stats().silent
+						   - silent) + " times, not 10");
+  }
+
+  //Six channels, much louder than the old floors. The first frame only
+  // seeds the new floors, so once the hold runs out the same level is
+  // gated.
+  std::vector<std::pair<float, float> > six(6, std::make_pair(0.0f, 4000.0f));
+  if(!site.gate.update(six, 4000.0f)){
+    fail("the first frame with a new channel count was gated");
+  }
+  if(site.gate.stats().channels != 6
+     || site.gate.stats().noiseFloor[5] != 4000.0f){
+    fail("the floors weren't seeded for the new channels");
+  }
+  bool open = true;
+  for(int f=0; f < 20 && open; f++){
+    open = site.gate.update(six, 4000.0f);
+  }
+  if(open){
+    fail("a steady level with a new channel count was never gated");
+  }
+}
+
+int main(){
+  std::mt19937 rng(17);
+  const float period = 1.0f/TARGET_FRAME_RATE;
+
+  std::cout << "one window per period" << std::endl;
+  checkSite("site", 1, rng);
+  checkHum("steady hum", period);
+  checkHold("hold", period, rng);
+  std::cout << "windows every quarter period" << std::endl;
+  checkSite("site", 4, rng);
+  checkHum("steady hum", period/4);
+  checkHold("hold", period/4, rng);
+  checkCounting(rng);
+
+  if(failures > 0){
+    std::cout << "FAILED: " << failures << " checks" << std::endl;
+    return 1;
+  }
+  std::cout << "NoiseGate passes every sound, absorbs hum, and holds in "
+	    << "seconds at any hop" << std::endl;
+  return 0;
+}
@@ -0,0 +1,161 @@
+/** \file gccPhatCheck.cpp
+ * Checks that GccPhat::delay, with and without PHAT weighting, recovers
+ * known shifts between channels: whole sample shifts of white noise
+ * exactly, and fractional shifts of band limited noise to within 0.2
+ * samples. The sign must match delay() in
+ * soundProcessing.h.
+ *
+ * Run with make check.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include <complex>
+
+#include "../gccPhat.h"
+#include "../fft.h"
+#include "../soundFrame.h"
+#include "../soundProcessing.h"
+
+/*! Failures so far */
+int failures = 0;
+
+/*! Count a failure and say what it was, if got is further than tolerance
+ *  from want */
+void expect(float got, float want, float tolerance, const char* what,
+	    bool phat){
+  if(!(std::fabs(got - want) <= tolerance)){
+    if(failures < 10){
+      std::cerr << what << (phat ? ", PHAT" : "") << ": got " << got
+		<< ", expected " << want << std::endl;
+    }
+    failures++;
+  }
+}
+
+int main(){
+  std::mt19937 rng(8);
+  const unsigned int frames = 1067, channels = 4;
+  const int range = 20;
+  //Each channel is a copy of the source, shifted by this many samples
+  // more than channel 0. Channel 3 is quieter, and has noise of its own.
+  std::vector<int16_t> samples(frames*channels);
+  std::vector<const int16_t*> ch(channels);
+  for(unsigned int c=0; c < channels; c++){
+    ch[c] = samples.data() + c*frames;
+  }
+  SoundFrame frame(frames, channels);
+  float worstFraction[2] = {0.0f, 0.0f};
+
+  for(int phat=0; phat < 2; phat++){
+    GccPhat gcc(frames, channels, range, phat);
+    
+    //Whole sample shifts of white noise
+    std::uniform_int_distribution<int> white(-8000, 8000);
+    std::uniform_int_distribution<int> shift(-range, range);
+    for(int trial=0; trial < 50; trial++){
+      std::vector<int> source(frames + 2*range);
+      for(int& s : source) s = white(rng);
+      int shifts[channels] = {0, shift(rng), shift(rng), shift(rng)};
+      for(unsigned int c=0; c < channels; c++){
+	for(unsigned int i=0; i < frames; i++){
+	  int v = source[i + range - shifts[c]];
+	  if(c == 3) v = v/2 + white(rng)/4;
+	  samples[c*frames + i] = v;
+	}
+      }
+      frame.set(ch.data(), frames, channels);
+      gcc.setFrame(frame);
+      for(unsigned int c=1; c < channels; c++){
+	//Channel c heard it shifts[c] samples after channel 0
+	expect(gcc.delay(0, c, range).first, shifts[c], 0.0f,
+	       "whole sample shift", phat);
+	expect(gcc.delay(c, 0, range).first, -shifts[c], 0.0f,
+	       "whole sample shift, reversed", phat);
+	expect(gcc.delay(0, c, range).first,
+	       delay(frame, 0, c, range).first, 0.0f,
+	       "same as the time domain delay", phat);
+      }
+    }
+
+    //Fractional shifts of noise with every frequency up to 90% of
+    // Nyquist. It is made as a spectrum, where a shift of any amount is
+    // exact: bin k is turned by exp(-2 pi i k shift/n). The signal is
+    // periodic, so the window cut from it has no edges.
+    const unsigned int n = 4096;
+    RealFFT synth(n);
+    std::vector<std::complex<float> > spectrum(n/2 + 1), shifted(n/2 + 1);
+    std::vector<float> signal(n);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    std::normal_distribution<float> normal;
+    for(int trial=0; trial < 50; trial++){
+      for(unsigned int k=0; k <= n/2; k++){
+	spectrum[k] = k > 0 && k < 0.9f*n/2
+	  ? std::complex<float>(normal(rng), normal(rng)) : 0.0f;
+      }
+      float shifts[channels];
+      for(unsigned int c=0; c < channels; c++){
+	shifts[c] = c == 0 ? 0.0f : (uniform(rng) - 0.5f)*2*(range - 2);
+	for(unsigned int k=0; k <= n/2; k++){
+	  shifted[k] = spectrum[k]*std::polar(1.0f, (float)(-2*M_PI*k/n)
+					      *shifts[c]);
+	}
+	synth.inverse(shifted.data(), signal.data());
+	for(unsigned int i=0; i < frames; i++){
+	  samples[c*frames + i] = (int16_t)std::lround(100000.0f*signal[i]);
+	}
+      }
+      frame.set(ch.data(), frames, channels);
+      gcc.setFrame(frame);
+      for(unsigned int c=1; c < channels; c++){
+	float got = gcc.delay(0, c, range, true).first;
+	worstFraction[phat] = std::max(worstFraction[phat],
+				       std::fabs(got - shifts[c]));
+	expect(got, shifts[c], 0.2f, "fractional shift", phat);
+	//Without refinement, the nearest whole sample, unless the shift is
+	// too close to halfway to tell
+	if(std::fabs(shifts[c] - std::round(shifts[c])) < 0.4f){
+	  expect(gcc.delay(0, c, range).first, std::round(shifts[c]), 0.0f,
+		 "fractional shift, rounded", phat);
+	}
+      }
+    }
+  }
+
+  std::cout << "worst fractional error " << worstFraction[0]
+	    << " samples, with PHAT " << worstFraction[1] << std::endl;
+  if(failures > 0){
+    std::cout << "FAILED: " << failures << " delays" << std::endl;
+    return 1;
+  }
+  std::cout << "GccPhat recovers every shift, with and without PHAT"
+	    << std::endl;
+  return 0;
+}
@@ -0,0 +1,108 @@
+/** \file linearTracker.h
+ * The original Tracker, which compares each new point to every sound
+ * and erases timed out sounds from the middle of its list. It is slow
+ * with many sounds, but simple enough to trust, so tests compare Tracker
+ * to it.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include "../tracker.h"
+#include "../constants.h"
+#include "../utils.h"
+
+/*! The original Tracker, without the singleton or the mutex. It uses
+ *  the same constants as tracker.cpp. */
+class LinearTracker {
+ public:
+  static constexpr float CLUSTER_DISTANCE = 0.5f;
+  static constexpr float SMOOTHING_FACTOR = 1.0f/6.0f;
+  static constexpr float TIMEOUT_FRAMES = 1.0f * TARGET_FRAME_RATE;
+
+  void addPoint(const Vec3& pt, float loudness, unsigned long frameNumber,
+		unsigned int bandMask = 0){
+    if(loudness < SILENCE_LOUDNESS) return;
+    claimed.clear();
+    addLocked(pt, loudness, frameNumber, bandMask);
+  }
+
+  void addPoints(const std::vector<Vec3>& pts, float loudness,
+		 unsigned long frameNumber){
+    if(loudness < SILENCE_LOUDNESS) return;
+    claimed.clear();
+    for(const Vec3& pt : pts){
+      claimed.push_back(addLocked(pt, loudness, frameNumber, 0));
+    }
+  }
+
+  std::vector<Trackable> getSoundsSince(unsigned long sFrameNum){
+    for(int i=sounds.size()-1; i >= 0; i--){
+      if(sounds[i].lastFrame + TIMEOUT_FRAMES < sFrameNum){
+	sounds.erase(sounds.begin() + i);
+      }
+    }
+    return sounds;
+  }
+
+ private:
+  unsigned int addLocked(const Vec3& pt, float loudness,
+			 unsigned long frameNumber, unsigned int bandMask){
+    float minDist = 100000.0f;
+    int minIndex = -1;
+    for(int i=0; i < (int)sounds.size(); i++){
+      float d = dist(pt, sounds[i].location);
+      if(d < minDist && sounds[i].lastFrame + TIMEOUT_FRAMES >= frameNumber
+	 && std::find(claimed.begin(), claimed.end(), (unsigned int)i)
+	 == claimed.end()){
+	minDist = d;
+	minIndex = i;
+      }
+    }
+
+    if(minIndex != -1 && minDist < CLUSTER_DISTANCE){
+      Trackable& s = sounds[minIndex];
+      s.loudness = std::max(loudness, s.loudness);
+      for(int k=0; k < 3; k++){
+	s.location[k] = (1.0f - SMOOTHING_FACTOR)*s.location[k]
+	  + SMOOTHING_FACTOR*pt[k];
+      }
+      s.lastFrame = frameNumber;
+      s.bands |= bandMask;
+      return minIndex;
+    }
+
+    sounds.push_back(Trackable(pt, frameNumber, frameNumber, loudness,
+			       bandMask));
+    return sounds.size() - 1;
+  }
+
+  std::vector<Trackable> sounds;
+  std::vector<unsigned int> claimed;
+};
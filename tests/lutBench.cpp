@@ -0,0 +1,142 @@
+/** \file lutBench.cpp
+ * Times lookups in the location LUT against the map based table it
+ * replaced, and compares how much memory each one holds.
+ *
+ * Run with make bench.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <new>
+#include <cstdlib>
+#include <cstdio>
+
+#include <malloc.h>
+#include <unistd.h>
+
+#include "../locationlut.h"
+#include "../geometry.h"
+#include "../utils.h"
+#include "mapLUT.h"
+
+/*! Bytes currently allocated with new */
+size_t liveBytes = 0;
+
+void* operator new(size_t n){
+  void* p = std::malloc(n);
+  if(p == nullptr){
+    throw std::bad_alloc();
+  }
+  liveBytes += malloc_usable_size(p);
+  return p;
+}
+
+void operator delete(void* p) noexcept {
+  if(p != nullptr){
+    liveBytes -= malloc_usable_size(p);
+  }
+  std::free(p);
+}
+
+/*! Keeps the compiler from skipping work whose result is unused */
+volatile float sink;
+
+int main(){
+  //Keep the lut.bin that LocationLUT builds out of the working directory
+  char dir[] = "/tmp/lutBenchXXXXXX";
+  if(mkdtemp(dir) == nullptr || chdir(dir) != 0){
+    std::cerr << "can't make a scratch directory" << std::endl;
+    return 1;
+  }
+  LocationLUT& lut = LocationLUT::getInstance();
+  std::remove("lut.bin");
+  rmdir(dir);
+  std::ostringstream packed(std::ios::binary);
+  LocationLUT::generateBinary(packed);
+
+  size_t before = liveBytes;
+  MapLUT* reference = new MapLUT();
+  size_t mapBytes = liveBytes - before;
+
+  //Delays of sounds from random directions, with a little noise, rounded
+  // to keys as the main loop would
+  std::mt19937 rng(8);
+  std::normal_distribution<float> normal(0.0f, 1.0f);
+  const unsigned int numKeys = 4096;
+  std::vector<Vec3> keys(numKeys);
+  for(Vec3& key : keys){
+    std::vector<float> src = {normal(rng), normal(rng), normal(rng)};
+    float mag = dist(src, std::vector<float>{0.0f, 0.0f, 0.0f});
+    for(float& c : src){
+      c *= 20.0f/mag;
+    }
+    float d0 = dist(src, MIC_LOCATIONS[0]);
+    for(int j=1; j <= 3; j++){
+      float d = (d0 - dist(src, MIC_LOCATIONS[j]))
+	*SPEED_OF_SOUND_SAMPLES_PER_METER + 0.7f*normal(rng);
+      key[j-1] = std::round(LUT_KEY_PREC*d)/LUT_KEY_PREC;
+    }
+  }
+
+  typedef std::chrono::steady_clock clock;
+  const unsigned int rounds = 50;
+  clock::time_point start = clock::now();
+  float total = 0.0f;
+  for(unsigned int r=0; r < rounds; r++){
+    for(const Vec3& key : keys){
+      total += reference->get({key[0], key[1], key[2]})[0];
+    }
+  }
+  double mapNs = std::chrono::duration<double, std::nano>(clock::now()
+							  - start).count()
+    /(rounds*numKeys);
+
+  LUTEntry entry;
+  start = clock::now();
+  for(unsigned int r=0; r < rounds*20; r++){
+    for(const Vec3& key : keys){
+      lut.get(key, entry);
+      total += entry[0];
+    }
+  }
+  double denseNs = std::chrono::duration<double, std::nano>(clock::now()
+							    - start).count()
+    /(rounds*20*numKeys);
+  sink = total;
+
+  std::cout << std::fixed << std::setprecision(1)
+	    << "lookup, unordered_map of vectors  " << std::setw(8) << mapNs
+	    << " ns, " << mapBytes/1024.0 << " KiB" << std::endl
+	    << "lookup, dense table               " << std::setw(8) << denseNs
+	    << " ns, " << packed.str().size()/1024.0 << " KiB" << std::endl;
+  delete reference;
+  return 0;
+}
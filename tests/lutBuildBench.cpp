@@ -0,0 +1,74 @@
+/** \file lutBuildBench.cpp
+ * Times building the location LUT from scratch, as happens when lut.bin
+ * is missing or stale, against the original serial map build. lutCheck
+ * shows the two give the same table.
+ *
+ * Run with make bench.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <chrono>
+#include <thread>
+
+#include "../locationlut.h"
+#include "mapLUT.h"
+
+int main(){
+  typedef std::chrono::steady_clock clock;
+  const int rounds = 3;
+
+  clock::time_point start = clock::now();
+  size_t entries = 0;
+  for(int r=0; r < rounds; r++){
+    MapLUT reference;
+    entries = reference.size();
+  }
+  double mapMs = std::chrono::duration<double, std::milli>(clock::now()
+							   - start).count()
+    /rounds;
+
+  start = clock::now();
+  size_t bytes = 0;
+  for(int r=0; r < rounds; r++){
+    std::ostringstream out(std::ios::binary);
+    LocationLUT::generateBinary(out);
+    bytes = out.str().size();
+  }
+  double buildMs = std::chrono::duration<double, std::milli>(clock::now()
+							     - start).count()
+    /rounds;
+
+  std::cout << std::fixed << std::setprecision(1)
+	    << "original serial map build    " << std::setw(8) << mapMs
+	    << " ms, " << entries << " entries" << std::endl
+	    << "buildLUT, packLUT, fillLUT   " << std::setw(8) << buildMs
+	    << " ms on " << std::thread::hardware_concurrency()
+	    << " threads, " << bytes << " bytes" << std::endl;
+  return 0;
+}
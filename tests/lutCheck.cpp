@@ -0,0 +1,149 @@
+/** \file lutCheck.cpp
+ * Checks the location LUT against the table it replaced: an
+ * unordered_map from whole sample keys to averaged directions, searched
+ * outward ring by ring when a key has no entry of its own.
+ *
+ * Every key of the padded table is looked up both ways. The directions
+ * must agree to within the 16 bit packing, and the counts exactly.
+ *
+ * Then keys exactly half a step off every key are looked up, and must get
+ * the entry of the key they round to, half away from zero, which is how
+ * offsetsForLocation rounds when the table is built.
+ *
+ * Run with make check.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+
+#include <unistd.h>
+
+#include "../locationlut.h"
+#include "mapLUT.h"
+
+int main(){
+  //LocationLUT builds lut.bin in the working directory, so keep it away
+  // from any real one
+  char dir[] = "/tmp/lutCheckXXXXXX";
+  if(mkdtemp(dir) == nullptr || chdir(dir) != 0){
+    std::cerr << "can't make a scratch directory" << std::endl;
+    return 1;
+  }
+  LocationLUT& lut = LocationLUT::getInstance();
+  std::remove("lut.bin");
+  rmdir(dir);
+  
+  MapLUT reference;
+  std::cout << "reference map has " << reference.size() << " entries"
+	    << std::endl;
+
+  int failures = 0;
+  unsigned long keys = 0, hits = 0;
+  LUTEntry entry;
+  for(int i=MIN_OFFSET - LUT_FILL_TICKS; i <= MAX_OFFSET + LUT_FILL_TICKS;
+      i++){
+    for(int j=MIN_OFFSET - LUT_FILL_TICKS; j <= MAX_OFFSET + LUT_FILL_TICKS;
+	j++){
+      for(int k=MIN_OFFSET - LUT_FILL_TICKS;
+	  k <= MAX_OFFSET + LUT_FILL_TICKS; k++){
+	std::vector<float> key = {(float)i, (float)j, (float)k};
+	std::vector<float> want = reference.get(key);
+	lut.get(Vec3{key[0], key[1], key[2]}, entry);
+	keys++;
+	hits += want[3] > 0.0f;
+	
+	bool same = entry[3] == want[3];
+	for(int d=0; d < 3 && same; d++){
+	  //16 bit fixed point directions, rounded
+	  same = std::fabs(entry[d] - want[d]) <= 0.6f/32767.0f
+	    || (want[3] < 0.0f && entry[d] == want[d]);
+	}
+	if(!same){
+	  if(failures < 10){
+	    std::cerr << "key " << i << " " << j << " " << k << ": got "
+		      << entry[0] << " " << entry[1] << " " << entry[2]
+		      << " x" << entry[3] << ", expected " << want[0] << " "
+		      << want[1] << " " << want[2] << " x" << want[3]
+		      << std::endl;
+	  }
+	  failures++;
+	}
+      }
+    }
+  }
+
+  std::cout << keys << " keys, " << hits << " with a direction" << std::endl;
+
+  //Half a step either way on each axis, from every key
+  const float half = 0.5f/LUT_KEY_PREC;
+  unsigned long halves = 0;
+  LUTEntry rounded;
+  for(int i=MIN_OFFSET - LUT_FILL_TICKS; i <= MAX_OFFSET + LUT_FILL_TICKS;
+      i++){
+    for(int j=MIN_OFFSET - LUT_FILL_TICKS; j <= MAX_OFFSET + LUT_FILL_TICKS;
+	j++){
+      for(int k=MIN_OFFSET - LUT_FILL_TICKS;
+	  k <= MAX_OFFSET + LUT_FILL_TICKS; k++){
+	for(int signs=0; signs < 8; signs++){
+	  Vec3 key = {i + (signs & 1 ? half : -half),
+		      j + (signs & 2 ? half : -half),
+		      k + (signs & 4 ? half : -half)};
+	  Vec3 whole;
+	  for(int d=0; d < 3; d++){
+	    whole[d] = std::round(LUT_KEY_PREC*key[d])/LUT_KEY_PREC;
+	  }
+	  lut.get(key, entry);
+	  lut.get(whole, rounded);
+	  halves++;
+	  if(entry != rounded){
+	    if(failures < 10){
+	      std::cerr << "half step key " << key[0] << " " << key[1] << " "
+			<< key[2] << ": got " << entry[0] << " " << entry[1]
+			<< " " << entry[2] << " x" << entry[3]
+			<< ", expected the entry of " << whole[0] << " "
+			<< whole[1] << " " << whole[2] << ", " << rounded[0]
+			<< " " << rounded[1] << " " << rounded[2] << " x"
+			<< rounded[3] << std::endl;
+	    }
+	    failures++;
+	  }
+	}
+      }
+    }
+  }
+  std::cout << halves << " half step keys" << std::endl;
+  if(failures > 0){
+    std::cout << "FAILED: " << failures << " keys differ" << std::endl;
+    return 1;
+  }
+  std::cout << "every key matches the map, and half steps round like "
+	    << "the table" << std::endl;
+  return 0;
+}
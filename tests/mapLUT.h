@@ -0,0 +1,142 @@
+/** \file mapLUT.h
+ * The location lookup table as it was first written, an unordered_map
+ * keyed by std::vector<float>, kept as a reference for the LUT checks and
+ * benchmarks. Builds for the same number of points, geometry and key
+ * precision as LocationLUT::buildLUT, one point at a time.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <cmath>
+#include <cstdlib>
+
+#include "../locationlut.h"
+#include "../spherepoints.h"
+#include "../geometry.h"
+#include "../utils.h"
+
+/*! The original map based LUT */
+class MapLUT {
+ public:
+  /*! Build the table, serially, the way the original buildLUT did */
+  MapLUT(){
+    static const std::vector<float> center = {0.0f, 0.0f, 0.0f};
+    float keysPer16k = LUT_KEY_PREC*SAMPLES_PER_SECOND/16000.0f;
+    std::vector<Vec3> pts = genPoints((int)(256*256*keysPer16k*keysPer16k));
+    float scale = 1.5;
+
+    std::unordered_map<key_t, std::vector<std::vector<float> >, key_hash>
+      found;
+    for(size_t i=0; i < pts.size(); i++){
+      std::vector<float> pt
+	= {scale*pts[i][0], scale*pts[i][1], scale*pts[i][2]};
+      if(dist(center, pt) < 0.05) continue;
+      found[offsetsFor(pt)].push_back(pt);
+    }
+
+    for(auto it=found.begin(); it != found.end(); ++it){
+      const std::vector<std::vector<float> >& bucket = it->second;
+      float x=0.0f, y=0.0f, z=0.0f;
+      for(const std::vector<float>& pt : bucket){
+	float mag = dist(center, pt);
+	x += pt[0]/mag;
+	y += pt[1]/mag;
+	z += pt[2]/mag;
+      }
+      x /= bucket.size();
+      y /= bucket.size();
+      z /= bucket.size();
+      lut[it->first] = {x, y, z, (float)bucket.size()};
+    }
+  }
+
+  /*! The original get: the key's own entry, or else the first entry
+   *  found searching cubes of 1 to LUT_FILL_TICKS ticks around it, with
+   *  x, then y, then z counting up. The inside of each cube was already
+   *  searched by the one before, so only its surface is tried. */
+  std::vector<float> get(std::vector<float> offsets) const {
+    auto found = lut.find(offsets);
+    if(found != lut.end()){
+      return found->second;
+    }
+    const float tick = 1/LUT_KEY_PREC;
+    key_t trial(3);
+    for(int t=1; t <= LUT_FILL_TICKS; t++){
+      for(int x=-t; x <= t; x++){
+	for(int y=-t; y <= t; y++){
+	  for(int z=-t; z <= t; z++){
+	    if(std::abs(x) != t && std::abs(y) != t && std::abs(z) != t){
+	      continue;
+	    }
+	    trial[0] = offsets[0] + x*tick;
+	    trial[1] = offsets[1] + y*tick;
+	    trial[2] = offsets[2] + z*tick;
+	    found = lut.find(trial);
+	    if(found != lut.end()){
+	      return found->second;
+	    }
+	  }
+	}
+      }
+    }
+    return {10.0f, 10.0f, 10.0f, -1.0f};
+  }
+
+  /*! Number of entries */
+  size_t size() const { return lut.size(); }
+
+ private:
+  typedef std::vector<float> key_t;
+
+  /*! The original hash, on the key's position in the cube */
+  struct key_hash {
+    std::size_t operator()(const key_t& k) const {
+      long size = LUT_KEY_PREC*(MAX_OFFSET - MIN_OFFSET);
+      long val = LUT_KEY_PREC*k[0] - LUT_KEY_PREC*MIN_OFFSET;
+      val = val*size + (LUT_KEY_PREC*k[1] - LUT_KEY_PREC*MIN_OFFSET);
+      val = val*size + (LUT_KEY_PREC*k[2] - LUT_KEY_PREC*MIN_OFFSET);
+      return std::hash<long>()(val);
+    }
+  };
+
+  /*! Delays of mics 1 to 3 against mic 0 for a point, rounded to keys */
+  static key_t offsetsFor(const std::vector<float>& pt){
+    float d0 = dist(pt, MIC_LOCATIONS[0]);
+    key_t ret(3);
+    for(int j=1; j <= 3; j++){
+      ret[j-1] = (float)std::round(LUT_KEY_PREC
+				   *((d0 - dist(pt, MIC_LOCATIONS[j]))
+				     *SPEED_OF_SOUND_SAMPLES_PER_METER))
+	/LUT_KEY_PREC;
+    }
+    return ret;
+  }
+
+  std::unordered_map<key_t, std::vector<float>, key_hash> lut;
+};
@@ -0,0 +1,159 @@
+/** \file slidingCheck.cpp
+ * Checks that SlidingWindow gives bit for bit the same stats and
+ * correlations as copying each window into a SoundFrame and calling
+ * correlateAllPairs, for several hops, with 4 and 6 channels. Some windows
+ * are skipped without being correlated, and the range sometimes changes,
+ * so the full recompute is checked as well as the slide.
+ *
+ * Run with make check.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <algorithm>
+
+#include "../slidingWindow.h"
+#include "../soundFrame.h"
+#include "../soundProcessing.h"
+
+/*! Failures so far */
+int failures = 0;
+
+/*! Count a failure and say where it was, if the two differ */
+template<typename T>
+void expect(const T& got, const T& want, const char* what,
+	    unsigned int channels, unsigned int hop, unsigned long w){
+  if(!(got == want)){
+    if(failures < 10){
+      std::cerr << channels << " channels, hop " << hop << ", window " << w
+		<< ": " << what << " differ" << std::endl;
+    }
+    failures++;
+  }
+}
+
+/*! Slide a window over a long signal, pushed a period at a time, and
+ *  check every window against a fresh copy of it
+ *
+ * \return number of windows checked
+ */
+unsigned long check(unsigned int channels, unsigned int window,
+		    unsigned int hop, unsigned int period, std::mt19937& rng){
+  const int maxRange = 40;
+  const unsigned int periods = 60;
+  
+  //Noise, plus a shared source reaching each channel a little later than
+  // the one before, so the curves have real peaks. Some samples are at
+  // full scale, to check the sums don't overflow.
+  std::uniform_int_distribution<int> noise(-3000, 3000);
+  std::uniform_int_distribution<int> loud(-32768, 32767);
+  std::vector<int> source(periods*period + 64);
+  for(int& s : source) s = loud(rng)/2;
+  std::vector<std::vector<int16_t> > signal(channels,
+					    std::vector<int16_t>(periods*period));
+  for(unsigned int ch=0; ch < channels; ch++){
+    for(unsigned int i=0; i < periods*period; i++){
+      int v = source[i + 64 - 3*ch] + noise(rng);
+      if(rng() % 500 == 0) v = loud(rng);
+      signal[ch][i] = (int16_t)std::max(-32768, std::min(32767, v));
+    }
+  }
+
+  SlidingWindow slide(window, hop, channels, maxRange, period);
+  PairCorrelations got(maxRange, channels), want(maxRange, channels);
+  SoundFrame frame(window, channels);
+  std::vector<int16_t> buffer(period*channels);
+  const int16_t* ch[MAX_CHANNELS];
+  
+  unsigned long windows = 0;
+  unsigned long start = 0;
+  for(unsigned int p=0; p < periods; p++){
+    for(unsigned int c=0; c < channels; c++){
+      std::copy(signal[c].begin() + p*period,
+		signal[c].begin() + (p + 1)*period,
+		buffer.begin() + c*period);
+    }
+    slide.push(buffer);
+    unsigned long pushed = (unsigned long)(p + 1)*period;
+    
+    while(slide.next()){
+      //The first window ends at the last sample pushed, and each one
+      // after that starts a hop later
+      start = windows == 0 ? pushed - window : start + hop;
+      windows++;
+      for(unsigned int c=0; c < channels; c++){
+	ch[c] = signal[c].data() + start;
+      }
+      frame.set(ch, window, channels);
+      expect(slide.stats(), frame.stats(), "stats", channels, hop, windows);
+
+      //Every fifth window or so isn't correlated, so the next one has to
+      // start over. So does a change of range.
+      if(rng() % 5 == 0) continue;
+      int range = rng() % 8 == 0 ? maxRange - 7 : maxRange;
+      slide.correlate(range, got);
+      correlateAllPairs(frame, range, want);
+      unsigned int used = numPairs(channels)*(2*range + 1);
+      expect(got.range, want.range, "ranges", channels, hop, windows);
+      expect(std::vector<int64_t>(got.sums.begin(), got.sums.begin() + used),
+	     std::vector<int64_t>(want.sums.begin(),
+				  want.sums.begin() + used),
+	     "sums", channels, hop, windows);
+      expect(std::vector<float>(got.curves.begin(),
+				got.curves.begin() + used),
+	     std::vector<float>(want.curves.begin(),
+				want.curves.begin() + used),
+	     "curves", channels, hop, windows);
+      expect(got.energy, want.energy, "energies", channels, hop, windows);
+    }
+  }
+  return windows;
+}
+
+int main(){
+  std::mt19937 rng(2016);
+  unsigned long windows = 0;
+  for(unsigned int channels : {4u, 6u}){
+    //A hop of 1, short hops, hops shorter than the range, a quarter, and
+    // no overlap at all. The periods don't line up with the hops.
+    for(unsigned int hop : {1u, 7u, 33u, 128u, 256u, 512u}){
+      windows += check(channels, 512, hop, 160, rng);
+    }
+    //The usual case, one window per period
+    windows += check(channels, 1067, 1067, 1067, rng);
+  }
+
+  if(failures > 0){
+    std::cout << "FAILED: " << failures << " mismatches" << std::endl;
+    return 1;
+  }
+  std::cout << "SlidingWindow matches correlateAllPairs on " << windows
+	    << " windows" << std::endl;
+  return 0;
+}
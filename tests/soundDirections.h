@@ -0,0 +1,86 @@
+/** \file soundDirections.h
+ * Sounds from random directions at the microphones in MIC_LOCATIONS, for
+ * the checks that correlate delayed noise and see whether the direction
+ * comes back: a random direction, when it reaches each mic, and how far
+ * the answer is from it. Also the failure count those checks share.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#pragma once
+
+#include <vector>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+#include "../geometry.h"
+#include "../constants.h"
+
+/*! Failures so far */
+static int failures = 0;
+
+/*! A random unit vector */
+inline Vec3 randomDirection(std::mt19937& rng){
+  std::normal_distribution<float> normal;
+  Vec3 v;
+  float len;
+  do {
+    v = Vec3{normal(rng), normal(rng), normal(rng)};
+    len = std::sqrt(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+  } while(len < 1e-3f);
+  return Vec3{v[0]/len, v[1]/len, v[2]/len};
+}
+
+/*! Angle between two unit vectors, in degrees */
+inline float degreesBetween(const Vec3& a, const Vec3& b){
+  float c = a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
+  return std::acos(std::max(-1.0f, std::min(1.0f, c)))*180.0f/M_PI;
+}
+
+/*! When sound from direction u reaches each mic, in samples, relative to
+ *  the origin. Mics further toward u hear it first. */
+inline std::vector<float> arrivals(const Vec3& u){
+  std::vector<float> t(MIC_LOCATIONS.size());
+  for(unsigned int i=0; i < t.size(); i++){
+    t[i] = 0.0f;
+    for(int k=0; k < 3; k++){
+      t[i] -= u[k]*MIC_LOCATIONS[i][k];
+    }
+    t[i] *= SPEED_OF_SOUND_SAMPLES_PER_METER;
+  }
+  return t;
+}
+
+/*! arrivals rounded to whole samples, for delaying noise between the
+ *  channels */
+inline std::vector<int> lateness(const Vec3& u){
+  std::vector<float> t = arrivals(u);
+  std::vector<int> ret(t.size());
+  for(unsigned int i=0; i < t.size(); i++){
+    ret[i] = (int)std::lround(t[i]);
+  }
+  return ret;
+}
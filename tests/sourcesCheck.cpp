@@ -0,0 +1,296 @@
+/** \file sourcesCheck.cpp
+ * Checks that SourceAssociator pulls apart two sounds heard at once.
+ * White noise from two known directions is delayed between the channels,
+ * mixed, and correlated the way main does it. Both sounds must come back,
+ * each with offsets of t_i - t_j to within a sample, which pins down the
+ * sign, and each set of offsets must be accepted by the least squares
+ * solver and point back at its sound. A single sound must give one set
+ * of offsets, not several.
+ *
+ * Run with make check.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+#include "../sourceAssociation.h"
+#include "../tdoa.h"
+#include "../geometry.h"
+#include "../soundProcessing.h"
+#include "../soundFrame.h"
+#include "soundDirections.h"
+
+/*! The confidence main asks of the least squares solver */
+constexpr float MIN_SOLVER_CONFIDENCE = 0.25f;
+
+/*! The offsets SourceAssociator should find for a sound: t_i - t_j at
+ *  pairIndex(i, j) */
+static std::vector<float> trueOffsets(const std::vector<int>& late){
+  unsigned int mics = late.size();
+  std::vector<float> ret(numPairs(mics));
+  for(unsigned int i=0; i < mics; i++){
+    for(unsigned int j=i+1; j < mics; j++){
+      ret[pairIndex(i, j, mics)] = late[i] - late[j];
+    }
+  }
+  return ret;
+}
+
+/*! Largest difference between two sets of offsets, in samples */
+static float worstDifference(const std::vector<float>& a,
+			     const std::vector<float>& b){
+  float worst = 0.0f;
+  for(unsigned int p=0; p < a.size(); p++){
+    worst = std::max(worst, std::fabs(a[p] - b[p]));
+  }
+  return worst;
+}
+
+/*! Whether two sounds are just one sample apart on some pair against
+ *  mic 0 */
+static bool merged(const std::vector<std::vector<int> >& lates){
+  for(unsigned int j=1; j < lates[0].size(); j++){
+    int a = lates[0][0] - lates[0][j];
+    int b = lates[1][0] - lates[1][j];
+    if(std::abs(a - b) == 1){
+      return true;
+    }
+  }
+  return false;
+}
+
+/*! Makes windows of noise from chosen directions, and turns them into the
+ *  normalized pair curves main hands to SourceAssociator. White noise
+ *  correlates to a needle, so two sounds a couple of samples apart on a
+ *  pair still give two peaks. */
+class Scene {
+ public:
+  Scene(unsigned int frames, int range) :
+    frames(frames), range(range), mics(MIC_LOCATIONS.size()),
+    curveLen(2*range + 1), source(frames + 2*range),
+    channels(mics, std::vector<int>(frames)),
+    samples(mics, std::vector<int16_t>(frames)),
+    frame(frames, mics), correlations(range, mics),
+    curves(numPairs(mics)*curveLen) {
+  }
+
+  /*! Curves for one window holding a sound from each direction */
+  const std::vector<float>& make(const std::vector<std::vector<int> >& lates,
+				 std::mt19937& rng){
+    std::uniform_int_distribution<int> sample(-2000, 2000);
+    for(std::vector<int>& ch : channels){
+      std::fill(ch.begin(), ch.end(), 0);
+    }
+    for(const std::vector<int>& late : lates){
+      for(int& x : source) x = sample(rng);
+      //Channel i hears the sound late[i] samples late
+      for(unsigned int i=0; i < mics; i++){
+	for(unsigned int k=0; k < frames; k++){
+	  channels[i][k] += source[k + range - late[i]];
+	}
+      }
+    }
+
+    const int16_t* ch[MAX_CHANNELS];
+    for(unsigned int i=0; i < mics; i++){
+      for(unsigned int k=0; k < frames; k++){
+	samples[i][k] = (int16_t)std::max(-32768,
+					  std::min(32767, channels[i][k]));
+      }
+      ch[i] = samples[i].data();
+    }
+    frame.set(ch, frames, mics);
+    correlateAllPairs(frame, range, correlations);
+    normalizedCurves(correlations, curves.data());
+    return curves;
+  }
+
+ private:
+  unsigned int frames;
+  int range;
+  unsigned int mics;
+  unsigned int curveLen;
+  std::vector<int> source;
+  std::vector<std::vector<int> > channels;
+  std::vector<std::vector<int16_t> > samples;
+  SoundFrame frame;
+  PairCorrelations correlations;
+  std::vector<float> curves;
+};
+
+/*! Check that one sound SourceAssociator found is one of the sounds
+ *  played, that no earlier sound was the same one, and that the solver
+ *  points back at it
+ *
+ * \param matched which of the sounds played have been found so far
+ */
+static void checkSound(const std::string& name, unsigned int trial,
+		       const std::vector<float>& offsets,
+		       const std::vector<std::vector<float> >& wanted,
+		       const std::vector<Vec3>& dirs,
+		       const TdoaSolver& solver, std::vector<bool>& matched,
+		       float tolerance){
+  int match = -1;
+  for(unsigned int s=0; s < wanted.size(); s++){
+    if(worstDifference(offsets, wanted[s]) <= 1.0f){
+      match = s;
+    }
+  }
+  if(match < 0 || matched[match]){
+    if(failures < 10){
+      std::cerr << name << ", trial " << trial << ": offsets";
+      for(float o : offsets) std::cerr << " " << o;
+      std::cerr << (match < 0 ? " are none of the sounds"
+		    : " are a sound already found") << std::endl;
+    }
+    failures++;
+    return;
+  }
+  matched[match] = true;
+
+  Vec3 dir;
+  float confidence = solver.solve(offsets, dir);
+  float off = degreesBetween(dir, dirs[match]);
+  if(confidence < MIN_SOLVER_CONFIDENCE || off > tolerance){
+    if(failures < 10){
+      std::cerr << name << ", trial " << trial << ": sound " << match
+		<< " solved with confidence " << confidence << ", "
+		<< off << " degrees off" << std::endl;
+    }
+    failures++;
+  }
+}
+
+/*! Every check, for the microphones now in MIC_LOCATIONS
+ *
+ * \param tolerance how far, in degrees, the solver may be from each sound
+ *        with delays rounded to whole samples
+ */
+void checkLayout(const std::string& layout, float tolerance,
+		 std::mt19937& rng){
+  const unsigned int mics = MIC_LOCATIONS.size();
+  //The same range main uses, plus the 2 it adds for the curves
+  const int range = std::max((int)(2*SENSOR_SPACING_SAMPLES),
+			     (int)std::ceil(maxMicDelay())) + 2;
+  const unsigned int trials = 200;
+  Scene scene(1067, range);
+  TdoaSolver solver;
+  std::cout << layout << ", " << mics << " mics" << std::endl;
+
+  //Two sounds, far enough apart that their delays against mic 0 differ
+  // by a few samples on some pair. On a pair where they are just one
+  // sample apart the two peaks merge into one, and no association can
+  // get both back, so those are skipped.
+  SourceAssociator two(2, range);
+  unsigned int both = 0;
+  for(unsigned int n=0; n < trials; n++){
+    std::vector<Vec3> dirs;
+    std::vector<std::vector<int> > lates;
+    std::vector<std::vector<float> > wanted;
+    do {
+      dirs = {randomDirection(rng), randomDirection(rng)};
+      lates = {lateness(dirs[0]), lateness(dirs[1])};
+      wanted = {trueOffsets(lates[0]), trueOffsets(lates[1])};
+    } while(degreesBetween(dirs[0], dirs[1]) < 60.0f
+	    || worstDifference(wanted[0], wanted[1]) < 3.0f
+	    || merged(lates));
+
+    const std::vector<float>& curves = scene.make(lates, rng);
+    bool subsample = n % 2 == 0;
+    unsigned int found = two.associate(curves.data(), subsample);
+    int before = failures;
+    if(found != 2){
+      if(failures < 10){
+	std::cerr << layout << ", trial " << n << ": found " << found
+		  << " of 2 sounds" << std::endl;
+      }
+      failures++;
+    }
+    std::vector<bool> matched(2, false);
+    for(unsigned int s=0; s < found; s++){
+      checkSound(layout, n, two.offsets(s), wanted, dirs, solver, matched,
+		 tolerance);
+    }
+    both += failures == before;
+  }
+  std::cout << "  two sounds: both found and solved in " << both << " of "
+	    << trials << " windows" << std::endl;
+
+  //One sound, looking for as many as there can be
+  SourceAssociator many(MAX_SOURCES, range);
+  unsigned int one = 0;
+  for(unsigned int n=0; n < trials; n++){
+    std::vector<Vec3> dirs = {randomDirection(rng)};
+    std::vector<std::vector<int> > lates = {lateness(dirs[0])};
+    std::vector<std::vector<float> > wanted = {trueOffsets(lates[0])};
+    const std::vector<float>& curves = scene.make(lates, rng);
+    unsigned int found = many.associate(curves.data(), n % 2 == 0);
+    int before = failures;
+    if(found != 1){
+      if(failures < 10){
+	std::cerr << layout << ", trial " << n << ": one sound gave "
+		  << found << " sets of offsets" << std::endl;
+      }
+      failures++;
+    }
+    std::vector<bool> matched(1, false);
+    if(found > 0){
+      checkSound(layout, n, many.offsets(0), wanted, dirs, solver, matched,
+		 tolerance);
+    }
+    one += failures == before;
+  }
+  std::cout << "  one sound: found once and solved in " << one << " of "
+	    << trials << " windows" << std::endl;
+}
+
+int main(){
+  std::mt19937 rng(23);
+  checkLayout("built in tetrahedron", 15.0f, rng);
+
+  //Two triangles, one above the other and turned by 60 degrees, about
+  // twice as wide as the built in array
+  std::vector<std::vector<float> > six;
+  for(int m=0; m < 6; m++){
+    float a = m*M_PI/3;
+    six.push_back({0.2f*std::cos(a), 0.2f*std::sin(a), m % 2 ? 0.15f : 0.0f});
+  }
+  MIC_LOCATIONS = six;
+  checkLayout("six mics on two levels", 10.0f, rng);
+
+  if(failures > 0){
+    std::cout << "FAILED: " << failures << " checks" << std::endl;
+    return 1;
+  }
+  std::cout << "SourceAssociator separates two sounds, and finds one once"
+	    << std::endl;
+  return 0;
+}
@@ -0,0 +1,73 @@
+/** \file spacingBench.cpp
+ * Times pointSpacing against comparing every pair of points, on
+ * genPoints sets up to the size buildLUT uses. spacingCheck shows the two
+ * give the same answer.
+ *
+ * Run with make bench.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+#include "../spherepoints.h"
+#include "bruteSpacing.h"
+
+int main(){
+  typedef std::chrono::steady_clock clock;
+
+  std::cout << "  points  pointSpacing  every pair" << std::endl;
+  double bruteMs = 0.0;
+  int bruteN = 1;
+  for(int n : {1024, 4096, 16384, 65536}){
+    std::vector<Vec3> pts = genPoints(n);
+    
+    clock::time_point start = clock::now();
+    volatile float sink = pointSpacing(pts).maxAngle;
+    double fastMs = std::chrono::duration<double, std::milli>(clock::now()
+							      - start).count();
+
+    std::cout << std::fixed << std::setprecision(1) << std::setw(8) << n
+	      << std::setw(11) << fastMs << " ms";
+    //Every pair of the biggest set takes several seconds, so estimate it
+    // from the last one, as it grows with n^2
+    if(n <= 16384){
+      start = clock::now();
+      sink = bruteSpacing(pts).maxAngle;
+      bruteMs = std::chrono::duration<double, std::milli>(clock::now()
+							  - start).count();
+      bruteN = n;
+      std::cout << std::setw(9) << bruteMs << " ms";
+    } else {
+      std::cout << std::setw(9) << bruteMs*n/bruteN*n/bruteN
+		<< " ms, estimated";
+    }
+    std::cout << std::endl;
+    (void)sink;
+  }
+  return 0;
+}
@@ -0,0 +1,119 @@
+/** \file spacingCheck.cpp
+ * Checks that pointSpacing, which only compares each point to those in
+ * nearby cells, finds the same spacing as comparing every pair, for
+ * genPoints sets of many sizes, the SphereGrid levels, and random points,
+ * and that points off the unit sphere are measured by direction alone.
+ *
+ * Run with make check.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <cmath>
+
+#include "../spherepoints.h"
+#include "bruteSpacing.h"
+
+/*! Compare pointSpacing to bruteSpacing for one set, and print both if
+ *  they differ */
+static bool same(const std::string& name, const std::vector<Vec3>& pts){
+  SpacingStats got = pointSpacing(pts, 16);
+  SpacingStats want = bruteSpacing(pts, 16);
+  if(got.minAngle == want.minAngle && got.maxAngle == want.maxAngle
+     && got.meanAngle == want.meanAngle && got.histogram == want.histogram){
+    return true;
+  }
+  std::cerr << name << " (" << pts.size() << " points): got min "
+	    << got.minAngle << " max " << got.maxAngle << " mean "
+	    << got.meanAngle << ", expected min " << want.minAngle << " max "
+	    << want.maxAngle << " mean " << want.meanAngle << std::endl;
+  return false;
+}
+
+int main(){
+  int sets = 0, failures = 0;
+  
+  for(int n : {2, 3, 5, 12, 100, 257, 1000, 4096, 10000}){
+    sets++;
+    failures += !same("genPoints", genPoints(n));
+  }
+
+  SphereGrid grid(5);
+  for(unsigned int level=0; level <= grid.finest(); level++){
+    std::vector<Vec3> pts(grid.points().begin(),
+			  grid.points().begin() + SphereGrid::size(level));
+    sets++;
+    failures += !same("SphereGrid level " + std::to_string(level), pts);
+  }
+
+  //Random points clump and leave gaps, which is the hard case for the
+  // cell search: some nearest neighbours are several cells away
+  std::mt19937 rng(12345);
+  std::normal_distribution<float> normal;
+  for(int n : {10, 500, 5000}){
+    std::vector<Vec3> pts(n);
+    for(Vec3& p : pts){
+      p = Vec3{normal(rng), normal(rng), normal(rng)};
+      float len = std::sqrt(p[0]*p[0] + p[1]*p[1] + p[2]*p[2]);
+      p = Vec3{p[0]/len, p[1]/len, p[2]/len};
+    }
+    sets++;
+    failures += !same("random", pts);
+  }
+
+  //Points off the unit sphere are measured by direction only, so the
+  // same directions at random lengths have the same spacing
+  std::uniform_real_distribution<float> scale(0.01f, 100.0f);
+  for(int n : {50, 2000}){
+    std::vector<Vec3> unit = genPoints(n);
+    std::vector<Vec3> scaled = unit;
+    for(Vec3& p : scaled){
+      float s = scale(rng);
+      p = Vec3{p[0]*s, p[1]*s, p[2]*s};
+    }
+    sets++;
+    failures += !same("scaled genPoints", scaled);
+    sets++;
+    if(std::fabs(maxMinAngle(scaled) - maxMinAngle(unit)) > 1e-4f){
+      std::cerr << "scaled genPoints (" << n << " points): max angle "
+		<< maxMinAngle(scaled) << ", unit length "
+		<< maxMinAngle(unit) << std::endl;
+      failures++;
+    }
+  }
+
+  if(failures > 0){
+    std::cout << "FAILED: " << failures << " of " << sets
+	      << " point sets differ" << std::endl;
+    return 1;
+  }
+  std::cout << "pointSpacing matches comparing every pair on " << sets
+	    << " point sets" << std::endl;
+  return 0;
+}
@@ -0,0 +1,147 @@
+/** \file sphereGridCheck.cpp
+ * Checks that SphereGrid::search, which only zooms in on the best few
+ * points of each level, finds the same best point as scoring every point
+ * of the finest level. The score fields are random sums of smooth bumps
+ * around the sphere, like the curves of SRP, with one bump a little
+ * higher than the rest so the best point is well defined.
+ *
+ * Run with make check.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+#include "../spherepoints.h"
+
+/*! A random unit vector */
+static Vec3 randomDirection(std::mt19937& rng){
+  std::normal_distribution<float> normal;
+  Vec3 v;
+  float len;
+  do {
+    v = Vec3{normal(rng), normal(rng), normal(rng)};
+    len = std::sqrt(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+  } while(len < 1e-3f);
+  return Vec3{v[0]/len, v[1]/len, v[2]/len};
+}
+
+/*! Sum of a few bumps, each exp(sharpness*(cos(angle to its centre) - 1))
+ *  times its height */
+struct Field {
+  std::vector<Vec3> centres;
+  std::vector<float> heights;
+  float sharpness;
+
+  float operator()(const Vec3& p) const {
+    float total = 0.0f;
+    for(unsigned int b=0; b < centres.size(); b++){
+      const Vec3& c = centres[b];
+      float cosine = p[0]*c[0] + p[1]*c[1] + p[2]*c[2];
+      total += heights[b]*std::exp(sharpness*(cosine - 1.0f));
+    }
+    return total;
+  }
+};
+
+/*! Search many random fields and compare each answer to the exhaustive
+ *  one
+ *
+ * \param sharpness how narrow the bumps are. A bump falls to half its
+ *        height about acos(1 - ln(2)/sharpness) from its centre.
+ * \return number of fields where the search found a different point
+ */
+unsigned int check(SphereGrid& grid, unsigned int startLevel,
+		   unsigned int beam, float sharpness, unsigned int fields,
+		   std::mt19937& rng){
+  const std::vector<Vec3>& pts = grid.points();
+  std::uniform_int_distribution<int> bumps(1, 4);
+  std::uniform_real_distribution<float> height(0.2f, 0.8f);
+  unsigned int wrong = 0;
+  unsigned long evaluations = 0;
+  for(unsigned int n=0; n < fields; n++){
+    Field field;
+    field.sharpness = sharpness;
+    int count = bumps(rng);
+    for(int b=0; b < count; b++){
+      field.centres.push_back(randomDirection(rng));
+      field.heights.push_back(b == 0 ? 1.0f : height(rng));
+    }
+
+    unsigned int want = 0;
+    for(unsigned int i=1; i < pts.size(); i++){
+      if(field(pts[i]) > field(pts[want])){
+	want = i;
+      }
+    }
+
+    float best;
+    unsigned int got = grid.search([&](unsigned int i){
+	return field(pts[i]);
+      }, startLevel, beam, best);
+    evaluations += grid.evaluations();
+    if(got != want || best != field(pts[want])){
+      if(wrong < 5){
+	std::cerr << "  field " << n << ": search found point " << got
+		  << " scoring " << best << ", best is " << want
+		  << " scoring " << field(pts[want]) << std::endl;
+      }
+      wrong++;
+    }
+  }
+  std::cout << "  level " << grid.finest() << " from " << startLevel
+	    << ", beam " << beam << ", sharpness " << sharpness << ": "
+	    << fields - wrong << " of " << fields << " fields agree, "
+	    << evaluations/fields << " of " << pts.size()
+	    << " points scored" << std::endl;
+  return wrong;
+}
+
+int main(){
+  std::mt19937 rng(21);
+  unsigned int failures = 0;
+
+  //Smaller grids, started at every level
+  SphereGrid small(4);
+  for(unsigned int start=1; start < small.finest(); start++){
+    failures += check(small, start, 4, 8.0f, 200, rng);
+  }
+  //What SrpLocator does, on bumps about as wide as its peaks
+  SphereGrid srp(6);
+  failures += check(srp, 3, 4, 20.0f, 100, rng);
+  failures += check(srp, 3, 1, 8.0f, 100, rng);
+
+  if(failures > 0){
+    std::cout << "FAILED: " << failures << " searches" << std::endl;
+    return 1;
+  }
+  std::cout << "SphereGrid::search finds the same best point as scoring "
+	    << "every point" << std::endl;
+  return 0;
+}
@@ -0,0 +1,207 @@
+/** \file srpCheck.cpp
+ * Checks that SrpLocator points at the sound. Curves are made for known
+ * directions in two ways: smooth peaks at the exact lags, and real
+ * correlations of noise delayed between the channels. Either way locate
+ * must come back close to the direction the sound came from, which also
+ * pins down the sign of the lags. Then checks that each SIMD scoring
+ * kernel the machine can run, AVX2 or NEON, gives exactly the same scores
+ * as the scalar one.
+ *
+ * Run with make check.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+#include "../srp.h"
+#include "../geometry.h"
+#include "../soundProcessing.h"
+#include "../soundFrame.h"
+#include "soundDirections.h"
+
+/*! Locate sounds from random directions, and check every answer is
+ *  within tolerance degrees of the truth
+ *
+ * \param makeCurves fills the curves for a direction
+ */
+template<typename MakeCurves>
+void checkDirections(const std::string& name, SrpLocator& srp,
+		     unsigned int count, float tolerance,
+		     MakeCurves makeCurves, std::mt19937& rng){
+  float worst = 0.0f;
+  for(unsigned int n=0; n < count; n++){
+    Vec3 u = randomDirection(rng);
+    const std::vector<float>& curves = makeCurves(u);
+    Vec3 dir;
+    srp.locate(curves.data(), dir);
+    float off = degreesBetween(dir, u);
+    worst = std::max(worst, off);
+    if(off > tolerance){
+      if(failures < 10){
+	std::cerr << name << ": sound from " << u[0] << " " << u[1] << " "
+		  << u[2] << " located at " << dir[0] << " " << dir[1] << " "
+		  << dir[2] << ", " << off << " degrees off" << std::endl;
+      }
+      failures++;
+    }
+  }
+  std::cout << "  " << name << ": worst of " << count << " directions is "
+	    << worst << " degrees off" << std::endl;
+}
+
+/*! Every check, for the microphones now in MIC_LOCATIONS */
+void checkLayout(const std::string& layout, std::mt19937& rng){
+  std::cout << layout << ", " << MIC_LOCATIONS.size() << " mics"
+	    << std::endl;
+  const unsigned int mics = MIC_LOCATIONS.size();
+  const unsigned int pairs = numPairs(mics);
+  //The same range main uses
+  const int range = std::max((int)(2*SENSOR_SPACING_SAMPLES),
+			     (int)std::ceil(maxMicDelay())) + 2;
+  const unsigned int curveLen = 2*range + 1;
+  SrpLocator srp(SRP_LEVELS, range);
+  std::vector<float> curves(pairs*curveLen);
+
+  //Smooth peaks of height 1 at the exact lag of each pair. Pair (i, j)
+  // peaks where channel j's copy of the sound lines up with channel i's,
+  // at t_j - t_i. SrpLocator rounds its lags to whole samples, which
+  // only tells apart directions a few degrees apart with these arrays.
+  checkDirections("smooth peaks", srp, 300, 8.0f, [&](const Vec3& u)
+		  -> const std::vector<float>& {
+      std::vector<float> t = arrivals(u);
+      for(unsigned int i=0; i < mics; i++){
+	for(unsigned int j=i+1; j < mics; j++){
+	  float* c = curves.data() + pairIndex(i, j, mics)*curveLen + range;
+	  for(int o=-range; o <= range; o++){
+	    float d = o - (t[j] - t[i]);
+	    c[o] = std::exp(-d*d/8.0f);
+	  }
+	}
+      }
+      return curves;
+    }, rng);
+
+  //Low passed noise, delayed by a whole number of samples per channel,
+  // correlated and normalized the way main does it. White noise would
+  // give needles too narrow for the coarse level to see.
+  const unsigned int frames = 1067;
+  const unsigned int smooth = 6;
+  std::uniform_int_distribution<int> sample(-4000, 4000);
+  std::vector<int> white(frames + 2*range + smooth);
+  std::vector<int16_t> source(frames + 2*range);
+  std::vector<std::vector<int16_t> > channels(mics,
+					      std::vector<int16_t>(frames));
+  SoundFrame frame(frames, mics);
+  PairCorrelations correlations(range, mics);
+  checkDirections("delayed noise", srp, 300, 12.0f, [&](const Vec3& u)
+		  -> const std::vector<float>& {
+      for(int& w : white) w = sample(rng);
+      for(unsigned int k=0; k < source.size(); k++){
+	int total = 0;
+	for(unsigned int m=0; m < smooth; m++) total += white[k + m];
+	source[k] = total;
+      }
+      std::vector<int> late = lateness(u);
+      const int16_t* ch[MAX_CHANNELS];
+      for(unsigned int i=0; i < mics; i++){
+	//Channel i hears the source late[i] samples late
+	for(unsigned int k=0; k < frames; k++){
+	  channels[i][k] = source[k + range - late[i]];
+	}
+	ch[i] = channels[i].data();
+      }
+      frame.set(ch, frames, mics);
+      correlateAllPairs(frame, range, correlations);
+      normalizedCurves(correlations, curves.data());
+      return curves;
+    }, rng);
+
+  //Every kernel this machine can run must give the same scores as the
+  // scalar one, bit for bit, on arbitrary curves
+  std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+  const char* best = SrpLocator::kernelName();
+  for(const char* name : {"avx2", "neon"}){
+    if(!SrpLocator::useKernel(name)){
+      continue;
+    }
+    unsigned int trials = 200, same = 0;
+    for(unsigned int n=0; n < trials; n++){
+      for(float& c : curves) c = uniform(rng);
+      Vec3 fastDir, scalarDir;
+      SrpLocator::useKernel(name);
+      float fastScore = srp.locate(curves.data(), fastDir);
+      std::vector<float> fast = srp.coarseScores();
+      SrpLocator::useKernel("scalar");
+      float scalarScore = srp.locate(curves.data(), scalarDir);
+      if(fast == srp.coarseScores() && fastScore == scalarScore
+	 && fastDir == scalarDir){
+	same++;
+      } else {
+	if(failures < 10){
+	  std::cerr << "  " << name << " and scalar scores differ"
+		    << std::endl;
+	}
+	failures++;
+      }
+    }
+    std::cout << "  " << name << " scores equal scalar on " << same
+	      << " of " << trials << " sets of curves" << std::endl;
+  }
+  if(std::string(best) == "scalar"){
+    std::cout << "  no SIMD scoring kernel on this machine, only the scalar "
+	      << "one runs" << std::endl;
+  }
+  SrpLocator::useKernel(best);
+}
+
+int main(){
+  std::mt19937 rng(20);
+  std::cout << "best SRP kernel: " << SrpLocator::kernelName() << std::endl;
+  checkLayout("built in tetrahedron", rng);
+
+  //Two triangles, one above the other and turned by 60 degrees, about
+  // twice as wide as the built in array
+  std::vector<std::vector<float> > six;
+  for(int m=0; m < 6; m++){
+    float a = m*M_PI/3;
+    six.push_back({0.2f*std::cos(a), 0.2f*std::sin(a), m % 2 ? 0.15f : 0.0f});
+  }
+  MIC_LOCATIONS = six;
+  checkLayout("six mics on two levels", rng);
+
+  if(failures > 0){
+    std::cout << "FAILED: " << failures << " checks" << std::endl;
+    return 1;
+  }
+  std::cout << "SrpLocator finds every direction, and its kernels agree"
+	    << std::endl;
+  return 0;
+}
@@ -0,0 +1,171 @@
+/** \file tdoaBench.cpp
+ * Compares the least squares direction solver with the LUT, for latency
+ * and for angular error, on the delays of sounds from random directions.
+ *
+ * Delays are the exact ones for a source 5 m away plus Gaussian noise.
+ * The LUT only takes whole sample keys, so it gets them rounded; the
+ * solver is tried on both the rounded and the unrounded delays, the
+ * second being what --subsample gives it.
+ *
+ * Run with make bench.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+#include <cstdio>
+
+#include <unistd.h>
+
+#include "../locationlut.h"
+#include "../tdoa.h"
+#include "../geometry.h"
+#include "../soundProcessing.h"
+#include "../utils.h"
+
+/*! Angle between two directions, in degrees. 180 if dir is not a
+ *  direction at all. */
+float angleBetween(const Vec3& dir, const Vec3& truth){
+  float mag = std::sqrt(dir[0]*dir[0] + dir[1]*dir[1] + dir[2]*dir[2]);
+  if(!(mag > 0.0f) || mag > 2.0f){
+    return 180.0f;
+  }
+  float c = (dir[0]*truth[0] + dir[1]*truth[1] + dir[2]*truth[2])/mag;
+  return std::acos(std::max(-1.0f, std::min(1.0f, c)))*180.0f/M_PI;
+}
+
+/*! Run one method over every case, and print its time per call and its
+ *  mean and 95th percentile error */
+void report(const char* name, const std::vector<Vec3>& truths,
+	    std::function<void(size_t, Vec3&)> method){
+  typedef std::chrono::steady_clock clock;
+  std::vector<Vec3> dirs(truths.size());
+  const int rounds = 20;
+  clock::time_point start = clock::now();
+  for(int r=0; r < rounds; r++){
+    for(size_t c=0; c < truths.size(); c++){
+      method(c, dirs[c]);
+    }
+  }
+  double ns = std::chrono::duration<double, std::nano>(clock::now()
+						       - start).count()
+    /(rounds*truths.size());
+
+  std::vector<float> errors(truths.size());
+  for(size_t c=0; c < truths.size(); c++){
+    errors[c] = angleBetween(dirs[c], truths[c]);
+  }
+
+  double mean = 0.0;
+  for(float e : errors){
+    mean += e;
+  }
+  mean /= errors.size();
+  std::sort(errors.begin(), errors.end());
+  std::cout << "  " << std::left << std::setw(28) << name << std::right
+	    << std::setw(7) << ns << " ns " << std::setw(7) << mean
+	    << " deg mean " << std::setw(7) << errors[errors.size()*95/100]
+	    << " deg 95%" << std::endl;
+}
+
+int main(){
+  //Keep the lut.bin that LocationLUT builds out of the working directory
+  char dir[] = "/tmp/tdoaBenchXXXXXX";
+  if(mkdtemp(dir) == nullptr || chdir(dir) != 0){
+    std::cerr << "can't make a scratch directory" << std::endl;
+    return 1;
+  }
+  LocationLUT& lut = LocationLUT::getInstance();
+  std::remove("lut.bin");
+  rmdir(dir);
+  TdoaSolver solver;
+
+  const unsigned int mics = MIC_LOCATIONS.size();
+  const unsigned int pairs = numPairs(mics);
+  const size_t cases = 4096;
+  std::mt19937 rng(13);
+  std::normal_distribution<float> normal(0.0f, 1.0f);
+
+  std::cout << std::fixed << std::setprecision(2);
+  for(float noise : {0.0f, 0.3f, 0.6f}){
+    std::vector<Vec3> truths(cases);
+    std::vector<std::vector<float> > exact(cases), rounded(cases);
+    for(size_t c=0; c < cases; c++){
+      Vec3 u = {normal(rng), normal(rng), normal(rng)};
+      float mag = std::sqrt(u[0]*u[0] + u[1]*u[1] + u[2]*u[2]);
+      std::vector<float> src(3);
+      for(int k=0; k < 3; k++){
+	u[k] /= mag;
+	src[k] = 5.0f*u[k];
+      }
+      truths[c] = u;
+
+      //t_i - t_j in samples, as the delay engines report them
+      std::vector<float> t(mics);
+      for(unsigned int i=0; i < mics; i++){
+	t[i] = dist(src, MIC_LOCATIONS[i])*SPEED_OF_SOUND_SAMPLES_PER_METER
+	  + noise*normal(rng);
+      }
+      exact[c].resize(pairs);
+      rounded[c].resize(pairs);
+      for(unsigned int i=0; i < mics; i++){
+	for(unsigned int j=i+1; j < mics; j++){
+	  unsigned int p = pairIndex(i, j, mics);
+	  exact[c][p] = t[i] - t[j];
+	  rounded[c][p] = std::round(t[i] - t[j]);
+	}
+      }
+    }
+
+    std::cout << "arrival time noise " << noise << " samples" << std::endl;
+    LUTEntry entry;
+    report("LUT, whole samples", truths, [&](size_t c, Vec3& d){
+	const std::vector<float>& o = rounded[c];
+	lut.get(Vec3{o[pairIndex(0, 1, mics)], o[pairIndex(0, 2, mics)],
+		    o[pairIndex(0, 3, mics)]}, entry);
+	d = {entry[0], entry[1], entry[2]};
+      });
+    report("solveFirst, whole samples", truths, [&](size_t c, Vec3& d){
+	const std::vector<float>& o = rounded[c];
+	float first[3] = {o[pairIndex(0, 1, mics)], o[pairIndex(0, 2, mics)],
+			  o[pairIndex(0, 3, mics)]};
+	solver.solveFirst(first, d);
+      });
+    report("solve, whole samples", truths, [&](size_t c, Vec3& d){
+	solver.solve(rounded[c], d);
+      });
+    report("solve, subsample", truths, [&](size_t c, Vec3& d){
+	solver.solve(exact[c], d);
+      });
+  }
+  return 0;
+}
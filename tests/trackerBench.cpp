@@ -0,0 +1,132 @@
+/** \file trackerBench.cpp
+ * Times Tracker::addPoint and Tracker::getSoundsSince with 10, 100 and
+ * 1000 live sounds, against the original linear scan. trackerCheck shows
+ * the two cluster sounds the same way.
+ *
+ * Run with make bench.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cmath>
+
+#include "../tracker.h"
+#include "../spherepoints.h"
+#include "linearTracker.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double microseconds(Clock::time_point start){
+  return std::chrono::duration<double, std::micro>(Clock::now()
+						   - start).count();
+}
+
+/*! Frames between sounds, so that each has timed out before the next */
+const unsigned long APART = LinearTracker::TIMEOUT_FRAMES + 1;
+
+/*! Time one tracker with n live sounds, spread evenly over the sphere.
+ *  frame is moved past anything the tracker has seen, so it starts
+ *  empty. */
+template<typename T>
+void bench(T& tracker, const std::string& name, unsigned int n,
+	   unsigned long& frame){
+  const float loud = 1000.0f;
+  std::vector<Vec3> pts = genPoints(n);
+  frame += 1000000;
+  tracker.getSoundsSince(frame);
+  //No two points of one batch join the same sound, so this makes n
+  tracker.addPoints(pts, loud, frame);
+  size_t live = tracker.getSoundsSince(frame).size();
+
+  //Each point lands a little way from one of the sounds and joins it
+  std::mt19937 rng(7);
+  std::normal_distribution<float> normal(0.0f, 0.02f);
+  std::vector<Vec3> near(4096);
+  for(unsigned int i=0; i < near.size(); i++){
+    const Vec3& p = pts[i % n];
+    Vec3 q = {p[0] + normal(rng), p[1] + normal(rng), p[2] + normal(rng)};
+    float len = std::sqrt(q[0]*q[0] + q[1]*q[1] + q[2]*q[2]);
+    near[i] = Vec3{q[0]/len, q[1]/len, q[2]/len};
+  }
+  const int adds = 200000;
+  Clock::time_point start = Clock::now();
+  for(int i=0; i < adds; i++){
+    tracker.addPoint(near[i % near.size()], loud, frame);
+  }
+  double addUs = microseconds(start)/adds;
+
+  //Nothing times out, so this is the cost of checking and copying
+  const int gets = 2000;
+  start = Clock::now();
+  for(int i=0; i < gets; i++){
+    tracker.getSoundsSince(frame);
+  }
+  double keepUs = microseconds(start)/gets;
+
+  //n sounds heard one after the other, far enough apart that the older
+  // half has timed out
+  const int rounds = 200;
+  double halfUs = 0.0;
+  for(int r=0; r < rounds; r++){
+    frame += 1000000;
+    tracker.getSoundsSince(frame);
+    unsigned long first = frame;
+    for(unsigned int j=0; j < n; j++){
+      frame = first + j*APART;
+      tracker.addPoint(pts[j], loud, frame);
+    }
+    start = Clock::now();
+    tracker.getSoundsSince(first + (n/2)*APART + APART - 1);
+    halfUs += microseconds(start);
+  }
+  halfUs /= rounds;
+
+  std::cout << std::setw(8) << n << std::setw(8) << live << "  "
+	    << std::left << std::setw(12) << name << std::right
+	    << std::fixed << std::setprecision(3) << std::setw(10) << addUs
+	    << std::setprecision(2) << std::setw(14) << keepUs
+	    << std::setw(14) << halfUs << std::endl;
+}
+
+int main(){
+  Tracker& tracker = Tracker::getInstance();
+  LinearTracker reference;
+  unsigned long frame = 0;
+
+  std::cout << "                          microseconds per call" << std::endl
+	    << "  sounds    live  tracker       addPoint  getSoundsSince"
+	    << "  half expire" << std::endl;
+  for(unsigned int n : {10u, 100u, 1000u}){
+    bench(reference, "linear scan", n, frame);
+    bench(tracker, "Tracker", n, frame);
+  }
+  return 0;
+}
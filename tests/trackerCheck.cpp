@@ -0,0 +1,145 @@
+/** \file trackerCheck.cpp
+ * Checks that Tracker, with its spatial index and swap and pop removal,
+ * clusters a long random trace of sounds the same way as the original
+ * linear scan. Sounds come out in a different order, so the lists are
+ * sorted before they are compared.
+ *
+ * Run with make check.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <tuple>
+#include <algorithm>
+
+#include "../tracker.h"
+#include "linearTracker.h"
+
+/*! A random unit vector */
+static Vec3 randomDirection(std::mt19937& rng){
+  std::normal_distribution<float> normal;
+  Vec3 v;
+  float len;
+  do {
+    v = Vec3{normal(rng), normal(rng), normal(rng)};
+    len = std::sqrt(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+  } while(len < 1e-3f);
+  return Vec3{v[0]/len, v[1]/len, v[2]/len};
+}
+
+/*! Sort sounds by when they were first heard, then by where */
+static void sortSounds(std::vector<Trackable>& sounds){
+  std::sort(sounds.begin(), sounds.end(),
+	    [](const Trackable& a, const Trackable& b){
+	      return std::tie(a.firstFrame, a.location[0], a.location[1],
+			      a.location[2])
+		< std::tie(b.firstFrame, b.location[0], b.location[1],
+			   b.location[2]);
+	    });
+}
+
+static bool sameSound(const Trackable& a, const Trackable& b){
+  return a.location == b.location && a.firstFrame == b.firstFrame
+    && a.lastFrame == b.lastFrame && a.loudness == b.loudness
+    && a.bands == b.bands;
+}
+
+int main(){
+  Tracker& tracker = Tracker::getInstance();
+  LinearTracker reference;
+  std::mt19937 rng(5);
+  std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+
+  //A few sources that stay put for a while, heard with some jitter, and
+  // random one off sounds in between
+  std::vector<Vec3> sources(6);
+  for(Vec3& s : sources) s = randomDirection(rng);
+  
+  unsigned long frame = 1000;
+  int compared = 0, failures = 0;
+  size_t most = 0;
+  for(int step=0; step < 200000; step++){
+    frame += uniform(rng) < 0.3f;
+    Vec3 pt = uniform(rng) < 0.6f ? sources[rng() % sources.size()]
+      : randomDirection(rng);
+    if(uniform(rng) < 0.6f){
+      Vec3 jitter = randomDirection(rng);
+      for(int k=0; k < 3; k++) pt[k] += 0.15f*jitter[k];
+      float len = std::sqrt(pt[0]*pt[0] + pt[1]*pt[1] + pt[2]*pt[2]);
+      for(int k=0; k < 3; k++) pt[k] /= len;
+    }
+    float loudness = 100.0f + 2000.0f*uniform(rng);
+    
+    if(uniform(rng) < 0.05f){
+      //No two points of a batch can join one sound, so big batches pile
+      // up many sounds close together
+      std::vector<Vec3> batch(1 + rng() % 40);
+      batch[0] = pt;
+      for(unsigned int b=1; b < batch.size(); b++){
+	batch[b] = randomDirection(rng);
+      }
+      tracker.addPoints(batch, loudness, frame);
+      reference.addPoints(batch, loudness, frame);
+    } else {
+      unsigned int band = uniform(rng) < 0.5f ? 0 : 1u << (rng() % 8);
+      tracker.addPoint(pt, loudness, frame, band);
+      reference.addPoint(pt, loudness, frame, band);
+    }
+
+    if(step % 97 == 0){
+      std::vector<Trackable> got = tracker.getSoundsSince(frame);
+      std::vector<Trackable> want = reference.getSoundsSince(frame);
+      sortSounds(got);
+      sortSounds(want);
+      most = std::max(most, want.size());
+      compared++;
+      bool same = got.size() == want.size()
+	&& std::equal(got.begin(), got.end(), want.begin(), sameSound);
+      if(!same){
+	if(failures < 10){
+	  std::cerr << "step " << step << ": " << got.size()
+		    << " sounds, expected " << want.size() << std::endl;
+	}
+	failures++;
+      }
+    }
+    if(step % 5000 == 0){
+      for(Vec3& s : sources) s = randomDirection(rng);
+    }
+  }
+
+  if(failures > 0){
+    std::cout << "FAILED: " << failures << " of " << compared
+	      << " lists of sounds differ" << std::endl;
+    return 1;
+  }
+  std::cout << "Tracker matches the linear scan on " << compared
+	    << " lists of up to " << most << " sounds" << std::endl;
+  return 0;
+}
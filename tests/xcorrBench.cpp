@@ -0,0 +1,141 @@
+/** \file xcorrBench.cpp
+ * Times the correlation of all six microphone pairs over one period, the
+ * way the time domain delay engine does it, with each kernel.
+ *
+ * Run with make bench.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+#include "../xcorrKernels.h"
+#include "../constants.h"
+
+/*! Keeps the compiler from skipping work whose result is unused */
+volatile int64_t sink;
+
+/*! Microseconds per call of f, averaged over enough calls to take about
+ *  half a second */
+template <typename F>
+double timeIt(F f){
+  typedef std::chrono::steady_clock clock;
+  f();
+  unsigned int calls = 0;
+  clock::time_point start = clock::now(), now;
+  do {
+    for(int i=0; i < 10; i++){
+      f();
+    }
+    calls += 10;
+    now = clock::now();
+  } while(now - start < std::chrono::milliseconds(500));
+  return std::chrono::duration<double, std::micro>(now - start).count()
+    /calls;
+}
+
+int main(){
+  const unsigned int channels = 4;
+  const unsigned int n = (unsigned int)(SAMPLES_PER_SECOND
+					/TARGET_FRAME_RATE + 0.5f);
+  const int range = (int)(2*SENSOR_SPACING_SAMPLES) + 2;
+  const unsigned int numLags = 2*range + 1;
+
+  std::mt19937 rng(4);
+  std::uniform_int_distribution<int> sample(-2000, 2000);
+  std::vector<int16_t> buffer(n*channels);
+  for(int16_t& s : buffer){
+    s = sample(rng);
+  }
+  std::vector<std::vector<int16_t> > planar(channels,
+					    std::vector<int16_t>(n));
+  for(unsigned int i=0; i < n; i++){
+    for(unsigned int ch=0; ch < channels; ch++){
+      planar[ch][i] = buffer[i*channels + ch];
+    }
+  }
+  const int16_t* ch[4] = {planar[0].data(), planar[1].data(),
+			  planar[2].data(), planar[3].data()};
+  std::vector<int64_t> sums(NUM_FUSED_PAIRS*numLags);
+
+  //What the delay engine did before the kernels: one strided float loop
+  // per pair and lag
+  double strided = timeIt([&](){
+      float total = 0.0f;
+      for(unsigned int a=0; a < channels; a++){
+	for(unsigned int b=a+1; b < channels; b++){
+	  for(int o=-range; o <= range; o++){
+	    int aOff = o < 0 ? -o : 0, bOff = o > 0 ? o : 0;
+	    for(int i=0; i < (int)n - std::abs(o); i++){
+	      total += (float)buffer[channels*(i+aOff)+a]
+		*(float)buffer[channels*(i+bOff)+b];
+	    }
+	  }
+	}
+      }
+      sink = (int64_t)total;
+    });
+  double scalar = timeIt([&](){
+      for(unsigned int a=0, p=0; a < channels; a++){
+	for(unsigned int b=a+1; b < channels; b++, p++){
+	  xcorrSumsScalar(ch[a], ch[b], n, -range, numLags,
+			  sums.data() + p*numLags);
+	}
+      }
+      sink = sums[0];
+    });
+  double perPair = timeIt([&](){
+      for(unsigned int a=0, p=0; a < channels; a++){
+	for(unsigned int b=a+1; b < channels; b++, p++){
+	  xcorrSums(ch[a], ch[b], n, -range, numLags,
+		    sums.data() + p*numLags);
+	}
+      }
+      sink = sums[0];
+    });
+  double fused = timeIt([&](){
+      xcorrSumsAllPairs(ch, n, -range, numLags, sums.data());
+      sink = sums[0];
+    });
+
+  std::cout << "6 pairs, " << n << " samples, " << numLags << " lags, kernel "
+	    << xcorrKernelName() << std::endl << std::fixed
+	    << std::setprecision(1)
+	    << "  strided float loop   " << std::setw(8) << strided << " us"
+	    << std::endl
+	    << "  xcorrSumsScalar      " << std::setw(8) << scalar << " us"
+	    << std::endl
+	    << "  xcorrSums per pair   " << std::setw(8) << perPair << " us"
+	    << std::endl
+	    << "  xcorrSumsAllPairs    " << std::setw(8) << fused << " us"
+	    << std::endl;
+  return 0;
+}
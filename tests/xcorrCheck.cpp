@@ -0,0 +1,198 @@
+/** \file xcorrCheck.cpp
+ * Checks that every cross correlation kernel this machine can run gives
+ * bit for bit the same sums as the original strided loop of
+ * dotWithOffset, done exactly. Each kernel is forced in turn with
+ * useXcorrKernel, so an AVX2 machine checks SSE2 and scalar as well.
+ *
+ * Run with make check. Exits non-zero if any sum differs.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <cstdlib>
+
+#include "../xcorrKernels.h"
+#include "../soundProcessing.h"
+#include "../constants.h"
+
+/*! Failures so far */
+int failures = 0;
+
+/*! Count a failure and say what it was, if the two differ */
+void expect(int64_t got, int64_t want, const char* what, int lag){
+  if(got != want){
+    if(failures < 10){
+      std::cerr << what << " lag " << lag << ": got " << got
+		<< ", expected " << want << std::endl;
+    }
+    failures++;
+  }
+}
+
+/*! The loop dotWithOffset used to run on interleaved samples, summed in
+ *  64 bit integers instead of floats so it is exact */
+int64_t stridedSum(const std::vector<int16_t>& buffer, unsigned int channels,
+		   unsigned int ch1, unsigned int ch2, int offset){
+  int frames = buffer.size()/channels;
+  int ch1offset = offset < 0 ? -offset : 0;
+  int ch2offset = offset > 0 ? offset : 0;
+  int64_t total = 0;
+  for(int i=0; i < frames - std::abs(offset); i++){
+    total += (int64_t)buffer[channels*(i+ch1offset)+ch1]
+      *buffer[channels*(i+ch2offset)+ch2];
+  }
+  return total;
+}
+
+/*! Check whichever kernel is in use against the exact sums */
+void checkKernel(){
+  std::mt19937 rng(4);
+  std::uniform_int_distribution<int> sample(-32768, 32767);
+  const unsigned int channels = 4;
+  const int range = 24;
+  const unsigned int numLags = 2*range + 1;
+
+  //Odd sizes catch the tails of the vector loops, and full scale
+  // samples catch overflow in the narrower lanes
+  for(unsigned int n : {1u, 7u, 33u, 250u, 1067u, 4096u}){
+    for(int fill=0; fill < 3; fill++){
+      //Random samples, random full scale ones, and nothing but -32768,
+      // the one input that overflows a 32 bit pair of products
+      std::vector<int16_t> buffer(n*channels);
+      for(int16_t& s : buffer){
+	s = fill == 0 ? sample(rng)
+	  : fill == 1 ? (rng() & 1 ? 32767 : -32768) : -32768;
+      }
+      std::vector<std::vector<int16_t> > planar(channels,
+						std::vector<int16_t>(n));
+      for(unsigned int i=0; i < n; i++){
+	for(unsigned int ch=0; ch < channels; ch++){
+	  planar[ch][i] = buffer[i*channels + ch];
+	}
+      }
+      const int16_t* ch[4] = {planar[0].data(), planar[1].data(),
+			      planar[2].data(), planar[3].data()};
+
+      std::vector<int64_t> fast(numLags), scalar(numLags);
+      std::vector<int64_t> fused(NUM_FUSED_PAIRS*numLags);
+      std::vector<int64_t> fusedScalar(NUM_FUSED_PAIRS*numLags);
+      xcorrSumsAllPairs(ch, n, -range, numLags, fused.data());
+      xcorrSumsAllPairsScalar(ch, n, -range, numLags, fusedScalar.data());
+      unsigned int p = 0;
+      for(unsigned int a=0; a < channels; a++){
+	for(unsigned int b=a+1; b < channels; b++, p++){
+	  xcorrSums(ch[a], ch[b], n, -range, numLags, fast.data());
+	  xcorrSumsScalar(ch[a], ch[b], n, -range, numLags, scalar.data());
+	  for(int o=-range; o <= range; o++){
+	    int64_t want = stridedSum(buffer, channels, a, b, o);
+	    expect(fast[o + range], want, "xcorrSums", o);
+	    expect(scalar[o + range], want, "xcorrSumsScalar", o);
+	    expect(fused[p*numLags + o + range], want, "xcorrSumsAllPairs", o);
+	    expect(fusedScalar[p*numLags + o + range], want,
+		   "xcorrSumsAllPairsScalar", o);
+	  }
+	}
+      }
+
+      //The sliding window sums a middle stretch, away from both ends
+      if(n > 2*range + 8){
+	int lo = range + 3, hi = n - range - 1;
+	xcorrRangeSums(ch[0], ch[1], lo, hi, -range, numLags, fast.data());
+	xcorrRangeSumsScalar(ch[0], ch[1], lo, hi, -range, numLags,
+			     scalar.data());
+	for(int o=-range; o <= range; o++){
+	  int64_t want = 0;
+	  for(int i=lo; i < hi; i++){
+	    want += (int64_t)ch[0][i]*ch[1][i + o];
+	  }
+	  expect(fast[o + range], want, "xcorrRangeSums", o);
+	  expect(scalar[o + range], want, "xcorrRangeSumsScalar", o);
+	}
+      }
+
+      //Decimator filters, with a length that isn't a whole vector
+      const unsigned int numTaps = 31, step = 3;
+      if(n >= numTaps){
+	unsigned int numOut = (n - numTaps)/step + 1;
+	std::vector<int16_t> taps(ch[2], ch[2] + numTaps);
+	std::vector<int64_t> out(numOut), outScalar(numOut);
+	firSums(ch[3], taps.data(), numTaps, step, numOut, out.data());
+	firSumsScalar(ch[3], taps.data(), numTaps, step, numOut,
+		      outScalar.data());
+	for(unsigned int k=0; k < numOut; k++){
+	  int64_t want = 0;
+	  for(unsigned int t=0; t < numTaps; t++){
+	    want += (int64_t)taps[t]*ch[3][k*step + t];
+	  }
+	  expect(out[k], want, "firSums", k);
+	  expect(outScalar[k], want, "firSumsScalar", k);
+	}
+      }
+
+      //And through the public interface, on interleaved samples
+      if(channels == NUM_CHANNELS && n > (unsigned int)range){
+	for(int o=-range; o <= range; o++){
+	  float want = (float)stridedSum(buffer, channels, 1, 2, o)
+	    /(n - std::abs(o));
+	  float got = dotWithOffset(buffer, 1, 2, o);
+	  if(got != want){
+	    std::cerr << "dotWithOffset lag " << o << ": got " << got
+		      << ", expected " << want << std::endl;
+	    failures++;
+	  }
+	}
+      }
+    }
+  }
+
+}
+
+int main(){
+  std::cout << "best xcorr kernel: " << xcorrKernelName() << std::endl;
+  //Every kernel this machine can run, not just the one it would pick
+  int checked = 0;
+  for(const char* name : {"avx2", "sse2", "neon", "scalar"}){
+    if(!useXcorrKernel(name)){
+      continue;
+    }
+    int before = failures;
+    checkKernel();
+    checked++;
+    std::cout << "  " << name << (failures == before ? " matches" : " FAILED")
+	      << std::endl;
+  }
+
+  if(failures > 0){
+    std::cout << "FAILED: " << failures << " sums differ" << std::endl;
+    return 1;
+  }
+  std::cout << "all " << checked
+	    << " kernels match the exact strided sums" << std::endl;
+  return 0;
+}
@@ -32,6 +32,8 @@
 #include "utils.h"
 
 #include <mutex>
+#include <algorithm>
+#include <cmath>
 
 /*! If a point is within this distance of an existing cluster, it should
  * join that cluster. Note that opposing points have distance 2.0 */
@@ -46,53 +48,113 @@ constexpr float TIMEOUT_SECONDS = 1.0f;
 /*! Timeout in frames instead of seconds, for convenience */
 constexpr float TIMEOUT_FRAMES = TIMEOUT_SECONDS * TARGET_FRAME_RATE;
 
+/*! The spatial index cuts each CLUSTER_DISTANCE into this many cells,
+ *  so a point's cluster is at most this many cells away on each axis.
+ *  Finer cells skip more far away sounds, but scan more empty cells;
+ *  1 was fastest from 10 to 1000 sounds. */
+constexpr unsigned int CELL_SPLIT = 1;
+/*! Edge length of a cell of the spatial index */
+constexpr float CELL_SIZE = CLUSTER_DISTANCE / CELL_SPLIT;
+/*! Cells along each axis of the cube from -1 to 1. Points past the last
+ *  cell, if any, are filed in it. */
+constexpr unsigned int CELLS_PER_AXIS = 2.0f / CELL_SIZE;
+/*! Index of the last cell along an axis */
+constexpr int LAST_CELL = CELLS_PER_AXIS - 1;
+
 /*! addPoint and getSoundsSince are called from different threads, so
  *  we need to guard with a mutex */
 std::mutex g_sounds_mutex;
 
-/*! Linear interpolation between two vectors. The length of the resulting
- *  vector is the minimum of the lenghts of the input vectors
+/*! Space for this many clusters is reserved up front, so that
+ *  addPoint doesn't allocate in normal use */
+constexpr unsigned int RESERVED_SOUNDS = 1024;
+
+/*! Batches of up to this many points are added without allocating */
+constexpr unsigned int RESERVED_BATCH = 16;
+
+/*! Linear interpolation between two vectors.
  *
  *  \param amt Amount of vector b to include. For example, 
  *  1.0 gives just vector b, 0.0
  *  gives vector a, and 0.5 gives the average of the two vectors.
- *  \param a The first vector, expected to have length 3
- *  \param b The second vector, expected to have length 3
+ *  \param a The first vector
+ *  \param b The second vector
  */
-std::vector<float> lerp(std::vector<float> a, std::vector<float> b, float amt){
+Vec3 lerp(const Vec3& a, const Vec3& b, float amt){
   //Keep 1-amt of a, add in amt of b
-  std::vector<float> ret;
-  for(int i=0; i < a.size() && i < b.size(); i++){
-    ret.push_back((1.0f-amt)*a[i] + amt*b[i]);
+  Vec3 ret;
+  for(int i=0; i < 3; i++){
+    ret[i] = (1.0f-amt)*a[i] + amt*b[i];
   }
 
   return ret;
 }
 
 Tracker::Tracker(){
+  sounds.reserve(RESERVED_SOUNDS);
+  cellHead.assign(CELLS_PER_AXIS*CELLS_PER_AXIS*CELLS_PER_AXIS, -1);
+  cellNext.reserve(RESERVED_SOUNDS);
+  cellPrev.reserve(RESERVED_SOUNDS);
+  cellOfSound.reserve(RESERVED_SOUNDS);
+  claimed.reserve(RESERVED_BATCH);
 }
 
 Tracker::~Tracker(){
 }
 
-void Tracker::addPoint(std::vector<float> pt, float loudness,
-		       unsigned long frameNumber){
+void Tracker::addPoint(const Vec3& pt, float loudness,
+		       unsigned long frameNumber, unsigned int bandMask){
+  if(loudness < SILENCE_LOUDNESS) return;
+  
+  std::lock_guard<std::mutex> guard(g_sounds_mutex);
+  claimed.clear();
+  addLocked(pt, loudness, frameNumber, bandMask);
+}
+
+void Tracker::addPoints(const std::vector<Vec3>& pts, float loudness,
+			unsigned long frameNumber){
   if(loudness < SILENCE_LOUDNESS) return;
   
   std::lock_guard<std::mutex> guard(g_sounds_mutex);
+  claimed.clear();
+  for(const Vec3& pt : pts){
+    claimed.push_back(addLocked(pt, loudness, frameNumber, 0));
+  }
+}
 
-  //First, find the closest sound that hasn't timed out
-  float minDist = 100000.0f;
+unsigned int Tracker::addLocked(const Vec3& pt, float loudness,
+				unsigned long frameNumber,
+				unsigned int bandMask){
+  //First, find the closest sound that hasn't timed out, and that no other
+  // point of this batch has joined. Only sounds within CLUSTER_DISTANCE
+  // can be joined, and those are all within CELL_SPLIT cells of pt on
+  // each axis. Ties go to the lowest index, as a scan of sounds would.
+  float minDist = CLUSTER_DISTANCE;
   int minIndex = -1;
-  for(int i=0; i<sounds.size(); i++){
-    float d = dist(pt, sounds[i].location);
-    if(d < minDist && sounds[i].lastFrame + TIMEOUT_FRAMES >= frameNumber){
-      minDist = d;
-      minIndex = i;
+  unsigned int c = cellOf(pt);
+  int cx = c / (CELLS_PER_AXIS*CELLS_PER_AXIS);
+  int cy = (c / CELLS_PER_AXIS) % CELLS_PER_AXIS;
+  int cz = c % CELLS_PER_AXIS;
+  int lo = -(int)CELL_SPLIT, hi = CELL_SPLIT;
+  for(int x = std::max(cx+lo, 0); x <= std::min(cx+hi, LAST_CELL); x++){
+    for(int y = std::max(cy+lo, 0); y <= std::min(cy+hi, LAST_CELL); y++){
+      for(int z = std::max(cz+lo, 0); z <= std::min(cz+hi, LAST_CELL); z++){
+	unsigned int cell = (x*CELLS_PER_AXIS + y)*CELLS_PER_AXIS + z;
+	for(int i = cellHead[cell]; i != -1; i = cellNext[i]){
+	  float d = dist(pt, sounds[i].location);
+	  if((d < minDist || (d == minDist && i < minIndex))
+	     && sounds[i].lastFrame + TIMEOUT_FRAMES >= frameNumber
+	     && std::find(claimed.begin(), claimed.end(), (unsigned int)i)
+	     == claimed.end()){
+	    minDist = d;
+	    minIndex = i;
+	  }
+	}
+      }
     }
   }
 
-  if(minIndex != -1 && minDist < CLUSTER_DISTANCE){
+  if(minIndex != -1){
     //If a good cluster is found, update it
 
     //Then do a weighted average with the new data. It might be
@@ -101,24 +163,86 @@ void Tracker::addPoint(std::vector<float> pt, float loudness,
     sounds[minIndex].location = lerp(sounds[minIndex].location, pt,
 				  SMOOTHING_FACTOR);
     sounds[minIndex].lastFrame = frameNumber;
-  } else {
-    //If a matching cluster not found, make a new one
-    sounds.push_back(Trackable(pt, frameNumber, frameNumber, loudness));
+    sounds[minIndex].bands |= bandMask;
+
+    //The average may have drifted into a neighbouring cell
+    unsigned int moved = cellOf(sounds[minIndex].location);
+    if(moved != cellOfSound[minIndex]){
+      unlink(minIndex);
+      link(minIndex, moved);
+    }
+    return minIndex;
   }
+  
+  //If a matching cluster not found, make a new one
+  sounds.push_back(Trackable(pt, frameNumber, frameNumber, loudness,
+			     bandMask));
+  cellNext.push_back(-1);
+  cellPrev.push_back(-1);
+  cellOfSound.push_back(c);
+  link(sounds.size() - 1, c);
+  return sounds.size() - 1;
 }
 
 std::vector<Trackable> Tracker::getSoundsSince(unsigned long sFrameNum){
   std::lock_guard<std::mutex> guard(g_sounds_mutex);
-  //Remove and sound that hasn't been heard recently
+  //Remove any sound that hasn't been heard recently. remove() moves the
+  // last sound, which has already been checked, into slot i.
   for(int i=sounds.size()-1; i >= 0; i--){
     if(sounds[i].lastFrame + TIMEOUT_FRAMES < sFrameNum){
-      sounds.erase(sounds.begin() + i);
+      remove(i);
     }
   }
   return sounds;
 }
+
+unsigned int Tracker::cellOf(const Vec3& pt) const {
+  unsigned int c = 0;
+  for(int i=0; i < 3; i++){
+    int k = (int)floorf((pt[i] + 1.0f) / CELL_SIZE);
+    c = c*CELLS_PER_AXIS + std::max(0, std::min(k, LAST_CELL));
+  }
+  return c;
+}
+
+void Tracker::link(unsigned int i, unsigned int c){
+  cellOfSound[i] = c;
+  cellPrev[i] = -1;
+  cellNext[i] = cellHead[c];
+  if(cellHead[c] != -1){
+    cellPrev[cellHead[c]] = i;
+  }
+  cellHead[c] = i;
+}
+
+void Tracker::unlink(unsigned int i){
+  if(cellPrev[i] != -1){
+    cellNext[cellPrev[i]] = cellNext[i];
+  } else {
+    cellHead[cellOfSound[i]] = cellNext[i];
+  }
+  if(cellNext[i] != -1){
+    cellPrev[cellNext[i]] = cellPrev[i];
+  }
+}
+
+void Tracker::remove(unsigned int i){
+  unsigned int last = sounds.size() - 1;
+  unlink(i);
+  if(i != last){
+    unsigned int c = cellOfSound[last];
+    unlink(last);
+    sounds[i] = sounds[last];
+    link(i, c);
+  }
+  sounds.pop_back();
+  cellNext.pop_back();
+  cellPrev.pop_back();
+  cellOfSound.pop_back();
+}
   
-Trackable::Trackable(std::vector<float> iloc, unsigned long iff,
-		     unsigned long ilf, float iloudness) :
-  location(iloc), firstFrame(iff), lastFrame(ilf), loudness(iloudness) {
+Trackable::Trackable(const Vec3& iloc, unsigned long iff,
+		     unsigned long ilf, float iloudness, unsigned int ibands) :
+  location(iloc), firstFrame(iff), lastFrame(ilf), loudness(iloudness),
+  bands(ibands) {
 }
@@ -31,19 +31,25 @@
 
 #include <vector>
 
+#include "utils.h"
+
 /*! Definition of a trackable object.*/
 struct Trackable {
   /*! A 3D unit vector, representing the direction of the sound */
-  std::vector<float> location;
+  Vec3               location;
   /*! When the sound was first heard at this location */
   unsigned long      firstFrame;
   /*! The last time a sound was heard from this location */
   unsigned long      lastFrame;
   /*! The loudest loudness of this sound over its lifetime */
   float              loudness;
+  /*! Frequency bands this sound has been heard in, one bit per band of
+   *  BandLocalizer. 0 if it has only been heard in the full band
+   *  signal. */
+  unsigned int       bands;
 
-  Trackable(std::vector<float> iloc, unsigned long iff, unsigned long ilf,
-	    float iloudness);
+  Trackable(const Vec3& iloc, unsigned long iff, unsigned long ilf,
+	    float iloudness, unsigned int ibands = 0);
 };
 
 /*! Manages a collection of Trackable, including clustering nearby sounds
@@ -82,9 +88,26 @@ class Tracker {
    *                 measure of how loud the sound was
    * \param frameNumber Time when this sound was heard, in terms of frames
    *                    of microphone input.
+   * \param bandMask The frequency band the direction was found in, as
+   *                 1 << band for a band of BandLocalizer. 0 for the full
+   *                 band signal.
+   */
+  void addPoint(const Vec3& pt, float loudness,
+		unsigned long frameNumber, unsigned int bandMask = 0);
+
+  /*! Add several points heard at the same time, such as two people
+   *  talking at once. Like calling addPoint for each, except that no two
+   *  of them can join the same sound, so they can't be averaged into one
+   *  direction that is neither.
+   *
+   * \param pts 3D unit vectors that indicate the directions of the
+   *            sounds, best first
+   * \param loudness The standard deviation of the signal
+   * \param frameNumber Time when these sounds were heard, in terms of
+   *                    frames of microphone input.
    */
-  void addPoint(std::vector<float> pt, float loudness,
-		unsigned long frameNumber);
+  void addPoints(const std::vector<Vec3>& pts, float loudness,
+		 unsigned long frameNumber);
 
   /*! Get a list of all sounds that have not timed out yet, and
    *  delete those that have timed out.
@@ -96,5 +119,32 @@ class Tracker {
   std::vector<Trackable> getSoundsSince(unsigned long frameNumber);
   
  private:
+  /*! Bucket of the index that a direction falls in */
+  unsigned int cellOf(const Vec3& pt) const;
+  /*! Put sound i at the front of the list for bucket c */
+  void link(unsigned int i, unsigned int c);
+  /*! Take sound i out of its bucket's list */
+  void unlink(unsigned int i);
+  /*! Remove sound i by moving the last sound into its slot */
+  void remove(unsigned int i);
+
+  /*! Body of addPoint, with the mutex already held. Returns the index of
+   *  the sound the point joined or started. */
+  unsigned int addLocked(const Vec3& pt, float loudness,
+			 unsigned long frameNumber, unsigned int bandMask);
+  
   std::vector<Trackable> sounds;
+  /*! Spatial index of sounds, so that addPoint only looks at sounds
+   *  near the new point. The cube around the unit sphere is cut into
+   *  cells, and each cell keeps a linked list of the sounds in it,
+   *  stored in the arrays below alongside sounds. */
+  std::vector<int> cellHead;
+  /*! Next sound in the same cell, or -1 */
+  std::vector<int> cellNext;
+  /*! Previous sound in the same cell, or -1 */
+  std::vector<int> cellPrev;
+  /*! Cell each sound is filed under */
+  std::vector<unsigned int> cellOfSound;
+  /*! Sounds already joined by a point of the current addPoints batch */
+  std::vector<unsigned int> claimed;
 };
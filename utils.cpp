@@ -37,3 +37,12 @@ float dist(std::vector<float> a, std::vector<float> b){
 
   return std::sqrt(total);
 }
+
+float dist(const Vec3& a, const Vec3& b){
+  float total = 0.0f;
+  for(int i=0; i < 3; i++){
+    total += (a[i] - b[i])*(a[i] - b[i]);
+  }
+
+  return std::sqrt(total);
+}
@@ -29,6 +29,11 @@
 #pragma once
 
 #include <vector>
+#include <array>
+
+/*! A point or direction in 3D. Fixed size, so unlike std::vector<float>
+ *  it never touches the heap. */
+typedef std::array<float, 3> Vec3;
 
 /*!
  * Compute the Euclidean distance between two three dimensional
@@ -36,3 +41,7 @@
  * undefined */
 float
 dist(std::vector<float> a, std::vector<float> b);
+
+/*! Compute the Euclidean distance between two points */
+float
+dist(const Vec3& a, const Vec3& b);
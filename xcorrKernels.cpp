@@ -0,0 +1,542 @@
+/** \file xcorrKernels.cpp
+ * Vectorized inner loops for time domain cross correlation.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#include "xcorrKernels.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define XCORR_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define XCORR_NEON
+#include <arm_neon.h>
+#endif
+
+/*! Number of lags each vectorized pass computes at once */
+constexpr int LAG_BLOCK = 4;
+
+/*! Signature of a kernel that sums x[i]*y[i+lag] over i in [lo, hi) for
+ *  LAG_BLOCK lags at once. The caller guarantees every index is valid. */
+typedef void (*BlockKernel)(const int16_t* x, const int16_t* y,
+			    int lo, int hi, const int* lags, int64_t* out);
+
+/*! Sum of x[i]*y[i+lag] for i in [lo, hi) */
+static int64_t sumRange(const int16_t* x, const int16_t* y,
+			int lo, int hi, int lag){
+  int64_t total = 0;
+  for(int i=lo; i < hi; i++){
+    total += (int32_t)x[i]*(int32_t)y[i+lag];
+  }
+  return total;
+}
+
+/*! Signature of a kernel that computes the sums for all six pairs of four
+ *  channels at one lag, over i in [lo, hi). The caller guarantees every
+ *  index is valid. */
+typedef void (*PairsKernel)(const int16_t* const* ch,
+			    int lo, int hi, int lag, int64_t* out);
+
+/*! Signature of a kernel that computes the sum of x[i]*y[i] for i in
+ *  [0, n) */
+typedef int64_t (*DotKernel)(const int16_t* x, const int16_t* y, int n);
+
+/*! Channel a and channel b of each fused pair */
+static const int PAIR_A[NUM_FUSED_PAIRS] = {0, 0, 0, 1, 1, 2};
+static const int PAIR_B[NUM_FUSED_PAIRS] = {1, 2, 3, 2, 3, 3};
+
+static void blockScalar(const int16_t* x, const int16_t* y,
+			int lo, int hi, const int* lags, int64_t* out){
+  for(int k=0; k < LAG_BLOCK; k++){
+    out[k] = sumRange(x, y, lo, hi, lags[k]);
+  }
+}
+
+static int64_t dotScalar(const int16_t* x, const int16_t* y, int n){
+  return sumRange(x, y, 0, n, 0);
+}
+
+static void pairsScalar(const int16_t* const* ch,
+			int lo, int hi, int lag, int64_t* out){
+  for(unsigned int p=0; p < NUM_FUSED_PAIRS; p++){
+    out[p] = sumRange(ch[PAIR_A[p]], ch[PAIR_B[p]], lo, hi, lag);
+  }
+}
+
+#ifdef XCORR_X86
+/*! Add the four int32 lanes of v into two int64x2 accumulators.
+ *
+ * _mm_madd_epi16 can only overflow in one case: both products are
+ * (-32768)*(-32768), giving 2^31, which wraps to INT32_MIN. No real
+ * sum of two products can be that negative, so INT32_MIN is widened
+ * as unsigned instead of sign extended.
+ */
+__attribute__((target("sse2")))
+static inline void widenAdd(__m128i v, __m128i& acc0, __m128i& acc1){
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i wrapped = _mm_set1_epi32(INT32_MIN);
+  __m128i sign = _mm_andnot_si128(_mm_cmpeq_epi32(v, wrapped),
+				  _mm_cmpgt_epi32(zero, v));
+  acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(v, sign));
+  acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(v, sign));
+}
+
+__attribute__((target("sse2")))
+static inline int64_t horizontalSum(__m128i acc0, __m128i acc1){
+  int64_t lanes[4];
+  _mm_storeu_si128((__m128i*)lanes, acc0);
+  _mm_storeu_si128((__m128i*)(lanes+2), acc1);
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+__attribute__((target("sse2")))
+static void blockSSE2(const int16_t* x, const int16_t* y,
+		      int lo, int hi, const int* lags, int64_t* out){
+  __m128i acc[LAG_BLOCK][2];
+  for(int k=0; k < LAG_BLOCK; k++){
+    acc[k][0] = acc[k][1] = _mm_setzero_si128();
+  }
+
+  int i = lo;
+  for(; i + 8 <= hi; i += 8){
+    __m128i xv = _mm_loadu_si128((const __m128i*)(x + i));
+    for(int k=0; k < LAG_BLOCK; k++){
+      __m128i yv = _mm_loadu_si128((const __m128i*)(y + i + lags[k]));
+      widenAdd(_mm_madd_epi16(xv, yv), acc[k][0], acc[k][1]);
+    }
+  }
+  
+  for(int k=0; k < LAG_BLOCK; k++){
+    out[k] = horizontalSum(acc[k][0], acc[k][1])
+      + sumRange(x, y, i, hi, lags[k]);
+  }
+}
+
+__attribute__((target("sse2")))
+static int64_t dotSSE2(const int16_t* x, const int16_t* y, int n){
+  __m128i acc0 = _mm_setzero_si128();
+  __m128i acc1 = _mm_setzero_si128();
+  int i = 0;
+  for(; i + 8 <= n; i += 8){
+    __m128i xv = _mm_loadu_si128((const __m128i*)(x + i));
+    __m128i yv = _mm_loadu_si128((const __m128i*)(y + i));
+    widenAdd(_mm_madd_epi16(xv, yv), acc0, acc1);
+  }
+  return horizontalSum(acc0, acc1) + sumRange(x, y, i, n, 0);
+}
+
+__attribute__((target("sse2")))
+static void pairsSSE2(const int16_t* const* ch,
+		      int lo, int hi, int lag, int64_t* out){
+  __m128i acc[NUM_FUSED_PAIRS][2];
+  for(unsigned int p=0; p < NUM_FUSED_PAIRS; p++){
+    acc[p][0] = acc[p][1] = _mm_setzero_si128();
+  }
+
+  int i = lo;
+  for(; i + 8 <= hi; i += 8){
+    //Three loads of x and three of y serve all six pairs
+    __m128i x0 = _mm_loadu_si128((const __m128i*)(ch[0] + i));
+    __m128i x1 = _mm_loadu_si128((const __m128i*)(ch[1] + i));
+    __m128i x2 = _mm_loadu_si128((const __m128i*)(ch[2] + i));
+    __m128i y1 = _mm_loadu_si128((const __m128i*)(ch[1] + i + lag));
+    __m128i y2 = _mm_loadu_si128((const __m128i*)(ch[2] + i + lag));
+    __m128i y3 = _mm_loadu_si128((const __m128i*)(ch[3] + i + lag));
+    widenAdd(_mm_madd_epi16(x0, y1), acc[0][0], acc[0][1]);
+    widenAdd(_mm_madd_epi16(x0, y2), acc[1][0], acc[1][1]);
+    widenAdd(_mm_madd_epi16(x0, y3), acc[2][0], acc[2][1]);
+    widenAdd(_mm_madd_epi16(x1, y2), acc[3][0], acc[3][1]);
+    widenAdd(_mm_madd_epi16(x1, y3), acc[4][0], acc[4][1]);
+    widenAdd(_mm_madd_epi16(x2, y3), acc[5][0], acc[5][1]);
+  }
+
+  for(unsigned int p=0; p < NUM_FUSED_PAIRS; p++){
+    out[p] = horizontalSum(acc[p][0], acc[p][1])
+      + sumRange(ch[PAIR_A[p]], ch[PAIR_B[p]], i, hi, lag);
+  }
+}
+
+/*! AVX2 version of widenAdd, see there for the overflow case */
+__attribute__((target("avx2")))
+static inline void widenAdd256(__m256i v, __m256i& acc0, __m256i& acc1){
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i wrapped = _mm256_set1_epi32(INT32_MIN);
+  __m256i sign = _mm256_andnot_si256(_mm256_cmpeq_epi32(v, wrapped),
+				     _mm256_cmpgt_epi32(zero, v));
+  acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(v, sign));
+  acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(v, sign));
+}
+
+__attribute__((target("avx2")))
+static void blockAVX2(const int16_t* x, const int16_t* y,
+		      int lo, int hi, const int* lags, int64_t* out){
+  __m256i acc[LAG_BLOCK][2];
+  for(int k=0; k < LAG_BLOCK; k++){
+    acc[k][0] = acc[k][1] = _mm256_setzero_si256();
+  }
+
+  int i = lo;
+  for(; i + 16 <= hi; i += 16){
+    __m256i xv = _mm256_loadu_si256((const __m256i*)(x + i));
+    for(int k=0; k < LAG_BLOCK; k++){
+      __m256i yv = _mm256_loadu_si256((const __m256i*)(y + i + lags[k]));
+      widenAdd256(_mm256_madd_epi16(xv, yv), acc[k][0], acc[k][1]);
+    }
+  }
+  
+  for(int k=0; k < LAG_BLOCK; k++){
+    int64_t lanes[8];
+    _mm256_storeu_si256((__m256i*)lanes, acc[k][0]);
+    _mm256_storeu_si256((__m256i*)(lanes+4), acc[k][1]);
+    int64_t total = 0;
+    for(int j=0; j < 8; j++){
+      total += lanes[j];
+    }
+    out[k] = total + sumRange(x, y, i, hi, lags[k]);
+  }
+}
+__attribute__((target("avx2")))
+static int64_t dotAVX2(const int16_t* x, const int16_t* y, int n){
+  __m256i acc0 = _mm256_setzero_si256();
+  __m256i acc1 = _mm256_setzero_si256();
+  int i = 0;
+  for(; i + 16 <= n; i += 16){
+    __m256i xv = _mm256_loadu_si256((const __m256i*)(x + i));
+    __m256i yv = _mm256_loadu_si256((const __m256i*)(y + i));
+    widenAdd256(_mm256_madd_epi16(xv, yv), acc0, acc1);
+  }
+  int64_t lanes[8];
+  _mm256_storeu_si256((__m256i*)lanes, acc0);
+  _mm256_storeu_si256((__m256i*)(lanes+4), acc1);
+  int64_t total = 0;
+  for(int j=0; j < 8; j++){
+    total += lanes[j];
+  }
+  return total + sumRange(x, y, i, n, 0);
+}
+
+__attribute__((target("avx2")))
+static void pairsAVX2(const int16_t* const* ch,
+		      int lo, int hi, int lag, int64_t* out){
+  __m256i acc[NUM_FUSED_PAIRS][2];
+  for(unsigned int p=0; p < NUM_FUSED_PAIRS; p++){
+    acc[p][0] = acc[p][1] = _mm256_setzero_si256();
+  }
+
+  int i = lo;
+  for(; i + 16 <= hi; i += 16){
+    __m256i x0 = _mm256_loadu_si256((const __m256i*)(ch[0] + i));
+    __m256i x1 = _mm256_loadu_si256((const __m256i*)(ch[1] + i));
+    __m256i x2 = _mm256_loadu_si256((const __m256i*)(ch[2] + i));
+    __m256i y1 = _mm256_loadu_si256((const __m256i*)(ch[1] + i + lag));
+    __m256i y2 = _mm256_loadu_si256((const __m256i*)(ch[2] + i + lag));
+    __m256i y3 = _mm256_loadu_si256((const __m256i*)(ch[3] + i + lag));
+    widenAdd256(_mm256_madd_epi16(x0, y1), acc[0][0], acc[0][1]);
+    widenAdd256(_mm256_madd_epi16(x0, y2), acc[1][0], acc[1][1]);
+    widenAdd256(_mm256_madd_epi16(x0, y3), acc[2][0], acc[2][1]);
+    widenAdd256(_mm256_madd_epi16(x1, y2), acc[3][0], acc[3][1]);
+    widenAdd256(_mm256_madd_epi16(x1, y3), acc[4][0], acc[4][1]);
+    widenAdd256(_mm256_madd_epi16(x2, y3), acc[5][0], acc[5][1]);
+  }
+
+  for(unsigned int p=0; p < NUM_FUSED_PAIRS; p++){
+    int64_t lanes[8];
+    _mm256_storeu_si256((__m256i*)lanes, acc[p][0]);
+    _mm256_storeu_si256((__m256i*)(lanes+4), acc[p][1]);
+    int64_t total = 0;
+    for(int j=0; j < 8; j++){
+      total += lanes[j];
+    }
+    out[p] = total + sumRange(ch[PAIR_A[p]], ch[PAIR_B[p]], i, hi, lag);
+  }
+}
+#endif
+
+#ifdef XCORR_NEON
+/*! acc += x*y, in 64 bits. Products are exact in 32 bits, and are widened
+ *  as they are added. */
+static inline void neonMulAcc(int16x8_t x, int16x8_t y, int64x2_t& acc){
+  acc = vpadalq_s32(acc, vmull_s16(vget_low_s16(x), vget_low_s16(y)));
+  acc = vpadalq_s32(acc, vmull_s16(vget_high_s16(x), vget_high_s16(y)));
+}
+
+static void blockNEON(const int16_t* x, const int16_t* y,
+		      int lo, int hi, const int* lags, int64_t* out){
+  int64x2_t acc[LAG_BLOCK];
+  for(int k=0; k < LAG_BLOCK; k++){
+    acc[k] = vdupq_n_s64(0);
+  }
+
+  int i = lo;
+  for(; i + 8 <= hi; i += 8){
+    int16x8_t xv = vld1q_s16(x + i);
+    for(int k=0; k < LAG_BLOCK; k++){
+      neonMulAcc(xv, vld1q_s16(y + i + lags[k]), acc[k]);
+    }
+  }
+
+  for(int k=0; k < LAG_BLOCK; k++){
+    out[k] = vgetq_lane_s64(acc[k], 0) + vgetq_lane_s64(acc[k], 1)
+      + sumRange(x, y, i, hi, lags[k]);
+  }
+}
+
+static int64_t dotNEON(const int16_t* x, const int16_t* y, int n){
+  int64x2_t acc = vdupq_n_s64(0);
+  int i = 0;
+  for(; i + 8 <= n; i += 8){
+    neonMulAcc(vld1q_s16(x + i), vld1q_s16(y + i), acc);
+  }
+  return vgetq_lane_s64(acc, 0) + vgetq_lane_s64(acc, 1)
+    + sumRange(x, y, i, n, 0);
+}
+
+static void pairsNEON(const int16_t* const* ch,
+		      int lo, int hi, int lag, int64_t* out){
+  int64x2_t acc[NUM_FUSED_PAIRS];
+  for(unsigned int p=0; p < NUM_FUSED_PAIRS; p++){
+    acc[p] = vdupq_n_s64(0);
+  }
+
+  int i = lo;
+  for(; i + 8 <= hi; i += 8){
+    int16x8_t x0 = vld1q_s16(ch[0] + i);
+    int16x8_t x1 = vld1q_s16(ch[1] + i);
+    int16x8_t x2 = vld1q_s16(ch[2] + i);
+    int16x8_t y1 = vld1q_s16(ch[1] + i + lag);
+    int16x8_t y2 = vld1q_s16(ch[2] + i + lag);
+    int16x8_t y3 = vld1q_s16(ch[3] + i + lag);
+    neonMulAcc(x0, y1, acc[0]);
+    neonMulAcc(x0, y2, acc[1]);
+    neonMulAcc(x0, y3, acc[2]);
+    neonMulAcc(x1, y2, acc[3]);
+    neonMulAcc(x1, y3, acc[4]);
+    neonMulAcc(x2, y3, acc[5]);
+  }
+
+  for(unsigned int p=0; p < NUM_FUSED_PAIRS; p++){
+    out[p] = vgetq_lane_s64(acc[p], 0) + vgetq_lane_s64(acc[p], 1)
+      + sumRange(ch[PAIR_A[p]], ch[PAIR_B[p]], i, hi, lag);
+  }
+}
+#endif
+
+/*! Shared driver: split the lags into blocks, run the block kernel over
+ *  the samples that every lag in the block has in common, and finish
+ *  the ragged ends of each lag one at a time. */
+static void xcorrSumsWith(BlockKernel kernel,
+			  const int16_t* x, const int16_t* y, unsigned int n,
+			  int minLag, unsigned int numLags, int64_t* sums){
+  int len = (int)n;
+  unsigned int l = 0;
+  for(; l + LAG_BLOCK <= numLags; l += LAG_BLOCK){
+    int lags[LAG_BLOCK];
+    int lo = 0;
+    int hi = len;
+    for(int k=0; k < LAG_BLOCK; k++){
+      lags[k] = minLag + (int)l + k;
+      lo = std::max(lo, -lags[k]);
+      hi = std::min(hi, len - lags[k]);
+    }
+
+    if(lo >= hi){
+      //Lags are so big there is nothing in common. Do them one at a time.
+      for(int k=0; k < LAG_BLOCK; k++){
+	sums[l+k] = sumRange(x, y, std::max(0, -lags[k]),
+			     std::min(len, len - lags[k]), lags[k]);
+      }
+      continue;
+    }
+
+    kernel(x, y, lo, hi, lags, sums + l);
+    for(int k=0; k < LAG_BLOCK; k++){
+      sums[l+k] += sumRange(x, y, std::max(0, -lags[k]), lo, lags[k]);
+      sums[l+k] += sumRange(x, y, hi, std::min(len, len - lags[k]), lags[k]);
+    }
+  }
+
+  for(; l < numLags; l++){
+    int lag = minLag + (int)l;
+    sums[l] = sumRange(x, y, std::max(0, -lag), std::min(len, len - lag), lag);
+  }
+}
+
+/*! Shared driver for xcorrRangeSums: the same i range for every lag, so
+ *  there are no ragged ends */
+static void xcorrRangeSumsWith(BlockKernel kernel,
+			       const int16_t* x, const int16_t* y,
+			       int lo, int hi, int minLag,
+			       unsigned int numLags, int64_t* sums){
+  if(lo >= hi){
+    std::fill(sums, sums + numLags, 0);
+    return;
+  }
+  unsigned int l = 0;
+  for(; l + LAG_BLOCK <= numLags; l += LAG_BLOCK){
+    int lags[LAG_BLOCK];
+    for(int k=0; k < LAG_BLOCK; k++){
+      lags[k] = minLag + (int)l + k;
+    }
+    kernel(x, y, lo, hi, lags, sums + l);
+  }
+  for(; l < numLags; l++){
+    sums[l] = sumRange(x, y, lo, hi, minLag + (int)l);
+  }
+}
+
+/*! Shared driver for the fused kernels. Every pair has the same valid
+ *  range at a given lag, so there are no ragged ends to finish. */
+static void xcorrSumsAllPairsWith(PairsKernel kernel,
+				  const int16_t* const* ch, unsigned int n,
+				  int minLag, unsigned int numLags,
+				  int64_t* sums){
+  int len = (int)n;
+  for(unsigned int l=0; l < numLags; l++){
+    int lag = minLag + (int)l;
+    int lo = std::max(0, -lag);
+    int hi = std::min(len, len - lag);
+    int64_t out[NUM_FUSED_PAIRS] = {0, 0, 0, 0, 0, 0};
+    if(lo < hi){
+      kernel(ch, lo, hi, lag, out);
+    }
+    for(unsigned int p=0; p < NUM_FUSED_PAIRS; p++){
+      sums[p*numLags + l] = out[p];
+    }
+  }
+}
+
+/*! Shared driver for firSums: one dot product per output */
+static void firSumsWith(DotKernel kernel,
+			const int16_t* x, const int16_t* taps,
+			unsigned int numTaps, unsigned int step,
+			unsigned int numOut, int64_t* sums){
+  for(unsigned int n=0; n < numOut; n++){
+    sums[n] = kernel(x + n*step, taps, (int)numTaps);
+  }
+}
+
+/*! The kernels xcorrSums, xcorrSumsAllPairs and firSums dispatch to, and
+ *  their name */
+struct KernelChoice {
+  BlockKernel kernel;
+  PairsKernel pairs;
+  DotKernel dot;
+  const char* name;
+};
+
+/*! Every kernel this machine can run, best first. Scalar is always
+ *  last. */
+static unsigned int supportedKernels(KernelChoice* out){
+  unsigned int n = 0;
+#ifdef XCORR_X86
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx2")){
+    out[n++] = KernelChoice{blockAVX2, pairsAVX2, dotAVX2, "avx2"};
+  }
+  if(__builtin_cpu_supports("sse2")){
+    out[n++] = KernelChoice{blockSSE2, pairsSSE2, dotSSE2, "sse2"};
+  }
+#endif
+#ifdef XCORR_NEON
+  out[n++] = KernelChoice{blockNEON, pairsNEON, dotNEON, "neon"};
+#endif
+  out[n++] = KernelChoice{blockScalar, pairsScalar, dotScalar, "scalar"};
+  return n;
+}
+
+/*! Decided once, the first time it is needed, unless useXcorrKernel
+ *  changes it */
+static KernelChoice& kernelChoice(){
+  static KernelChoice choice = [](){
+    KernelChoice all[4];
+    supportedKernels(all);
+    return all[0];
+  }();
+  return choice;
+}
+
+bool useXcorrKernel(const char* name){
+  KernelChoice all[4];
+  unsigned int n = supportedKernels(all);
+  for(unsigned int i=0; i < n; i++){
+    if(std::strcmp(all[i].name, name) == 0){
+      kernelChoice() = all[i];
+      return true;
+    }
+  }
+  return false;
+}
+
+void xcorrSums(const int16_t* x, const int16_t* y, unsigned int n,
+	       int minLag, unsigned int numLags, int64_t* sums){
+  xcorrSumsWith(kernelChoice().kernel, x, y, n, minLag, numLags, sums);
+}
+
+void xcorrSumsScalar(const int16_t* x, const int16_t* y, unsigned int n,
+		     int minLag, unsigned int numLags, int64_t* sums){
+  xcorrSumsWith(blockScalar, x, y, n, minLag, numLags, sums);
+}
+
+void xcorrSumsAllPairs(const int16_t* const* ch, unsigned int n,
+		       int minLag, unsigned int numLags, int64_t* sums){
+  xcorrSumsAllPairsWith(kernelChoice().pairs, ch, n, minLag, numLags, sums);
+}
+
+void xcorrSumsAllPairsScalar(const int16_t* const* ch, unsigned int n,
+			     int minLag, unsigned int numLags, int64_t* sums){
+  xcorrSumsAllPairsWith(pairsScalar, ch, n, minLag, numLags, sums);
+}
+
+void xcorrRangeSums(const int16_t* x, const int16_t* y, int lo, int hi,
+		    int minLag, unsigned int numLags, int64_t* sums){
+  xcorrRangeSumsWith(kernelChoice().kernel, x, y, lo, hi, minLag, numLags,
+		     sums);
+}
+
+void xcorrRangeSumsScalar(const int16_t* x, const int16_t* y, int lo, int hi,
+			  int minLag, unsigned int numLags, int64_t* sums){
+  xcorrRangeSumsWith(blockScalar, x, y, lo, hi, minLag, numLags, sums);
+}
+
+void firSums(const int16_t* x, const int16_t* taps, unsigned int numTaps,
+	     unsigned int step, unsigned int numOut, int64_t* sums){
+  firSumsWith(kernelChoice().dot, x, taps, numTaps, step, numOut, sums);
+}
+
+void firSumsScalar(const int16_t* x, const int16_t* taps,
+		   unsigned int numTaps, unsigned int step,
+		   unsigned int numOut, int64_t* sums){
+  firSumsWith(dotScalar, x, taps, numTaps, step, numOut, sums);
+}
+
+const char* xcorrKernelName(){
+  return kernelChoice().name;
+}
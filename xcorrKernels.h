@@ -0,0 +1,151 @@
+/** \file xcorrKernels.h
+ * Vectorized inner loops for time domain cross correlation.
+ *
+ * The kernels work on one channel at a time (not interleaved) and compute
+ * a whole block of lags per pass, so each sample of the first channel is
+ * loaded once per block instead of once per lag. There are versions for
+ * NEON (ARM), SSE2 and AVX2 (x86), plus a plain C++ fallback. The best
+ * one available is picked at run time.
+ *
+ * firSums, the filter behind Decimator, uses the same kernels with a
+ * single lag.
+ *
+ * All versions accumulate in 64 bit integers, which is exact, so every
+ * kernel returns bit for bit the same answer as xcorrSumsScalar.
+ *
+ * \note On 32 bit Raspbian the NEON kernel is only compiled in if the
+ * compiler is told the FPU has NEON, for example with -mfpu=neon.
+ *
+ * \author agent <agent@local>
+ * \date 2026-10-17
+ */
+
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **/
+
+#pragma once
+
+#include <cstdint>
+
+/*! Cross correlation sums of two signals, for a block of consecutive lags.
+ *
+ * \param x first signal
+ * \param y second signal
+ * \param n number of samples in each signal
+ * \param minLag first lag to compute. May be negative.
+ * \param numLags how many lags to compute
+ * \param sums receives numLags values. For lag \f$o\f$, 
+ *        sums[o - minLag] is \f$\sum_i x_i y_{i+o}\f$, summed over
+ *        every \f$i\f$ for which both samples exist.
+ */
+void xcorrSums(const int16_t* x, const int16_t* y, unsigned int n,
+	       int minLag, unsigned int numLags, int64_t* sums);
+
+/*! Number of distinct pairs among four channels, the number of lag curves
+ *  xcorrSumsAllPairs produces */
+constexpr unsigned int NUM_FUSED_PAIRS = 6;
+
+/*! Cross correlation sums for all six pairs of four channels, in one call.
+ *
+ * Equivalent to six calls to xcorrSums, but each block of samples is
+ * loaded once and used by every pair, instead of once per pair.
+ *
+ * \param ch four signals, n samples each
+ * \param n number of samples in each signal
+ * \param minLag first lag to compute. May be negative.
+ * \param numLags how many lags to compute
+ * \param sums receives NUM_FUSED_PAIRS*numLags values. Pair p, lag o is at
+ *        sums[p*numLags + o - minLag]. The pairs are, in order, (0,1),
+ *        (0,2), (0,3), (1,2), (1,3) and (2,3). For pair (a,b), channel a
+ *        is x and channel b is y, as in xcorrSums.
+ */
+void xcorrSumsAllPairs(const int16_t* const* ch, unsigned int n,
+		       int minLag, unsigned int numLags, int64_t* sums);
+
+/*! Plain C++ version of xcorrSumsAllPairs, which the vectorized versions
+ *  must match exactly */
+void xcorrSumsAllPairsScalar(const int16_t* const* ch, unsigned int n,
+			     int minLag, unsigned int numLags, int64_t* sums);
+
+/*! Plain C++ version of xcorrSums. Always available, and the reference
+ *  that the vectorized versions must match exactly. */
+void xcorrSumsScalar(const int16_t* x, const int16_t* y, unsigned int n,
+		     int minLag, unsigned int numLags, int64_t* sums);
+
+/*! Cross correlation sums over a fixed range of the first signal, for a
+ *  block of consecutive lags. Unlike xcorrSums, nothing is clipped at the
+ *  ends, which makes it the building block for updating sums as a window
+ *  slides, see SlidingWindow.
+ *
+ * \param x first signal
+ * \param y second signal
+ * \param lo first index of x to sum over
+ * \param hi one past the last index of x to sum over
+ * \param minLag first lag to compute. May be negative.
+ * \param numLags how many lags to compute
+ * \param sums receives numLags values. For lag \f$o\f$, sums[o - minLag]
+ *        is \f$\sum_{i=lo}^{hi-1} x_i y_{i+o}\f$. Every one of those
+ *        indices must be valid.
+ */
+void xcorrRangeSums(const int16_t* x, const int16_t* y, int lo, int hi,
+		    int minLag, unsigned int numLags, int64_t* sums);
+
+/*! Plain C++ version of xcorrRangeSums, which the vectorized versions
+ *  must match exactly */
+void xcorrRangeSumsScalar(const int16_t* x, const int16_t* y, int lo, int hi,
+			  int minLag, unsigned int numLags, int64_t* sums);
+
+/*! FIR filter sums, keeping only every step-th output. This is the whole
+ *  of a polyphase decimator: outputs that would be thrown away are never
+ *  computed.
+ *
+ * \param x input signal, at least (numOut-1)*step + numTaps samples
+ * \param taps filter coefficients, in the same order as the samples they
+ *        multiply
+ * \param numTaps length of the filter
+ * \param step distance in x between consecutive outputs
+ * \param numOut number of outputs to compute
+ * \param sums receives numOut values. sums[n] is
+ *        \f$\sum_k taps_k x_{n \cdot step + k}\f$.
+ */
+void firSums(const int16_t* x, const int16_t* taps, unsigned int numTaps,
+	     unsigned int step, unsigned int numOut, int64_t* sums);
+
+/*! Plain C++ version of firSums, which the vectorized versions must match
+ *  exactly */
+void firSumsScalar(const int16_t* x, const int16_t* taps,
+		   unsigned int numTaps, unsigned int step,
+		   unsigned int numOut, int64_t* sums);
+
+/*! Name of the kernel xcorrSums is using on this machine ("scalar",
+ *  "sse2", "avx2" or "neon") */
+const char* xcorrKernelName();
+
+/*! Make xcorrSums, xcorrSumsAllPairs, xcorrRangeSums and firSums use the
+ *  named kernel instead of the best one, so tests can check each kernel
+ *  the machine has. Not thread safe: call it before any other thread uses
+ *  the kernels.
+ *
+ * \param name "scalar", "sse2", "avx2" or "neon"
+ * \return false, changing nothing, if that kernel isn't compiled in or
+ *         the CPU doesn't support it
+ */
+bool useXcorrKernel(const char* name);